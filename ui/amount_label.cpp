@@ -39,7 +39,7 @@ AmountLabel::AmountLabel(not_null<QWidget *> parent, rpl::producer<FormattedAmou
     , _large(parent, LargeText(rpl::duplicate(amount)), st.large)
     , _small(parent, SmallText(rpl::duplicate(amount)), st.small)
     , _token(Token(amount))
-    , _diamond(!st.diamond ? nullptr : std::make_unique<LottieAnimation>(parent, LottieFromResource("diamond")))
+    , _diamond(!st.diamond ? nullptr : std::make_unique<LottieAnimation>(parent, LottieSharedResource{"diamond"}))
     , _tokenIcon(!st.diamond ? nullptr : std::make_unique<Ui::FixedHeightWidget>(parent)) {
   const auto currentToken = _tokenIcon->lifetime().make_state<Ton::Symbol>(Ton::Symbol::ton());
 
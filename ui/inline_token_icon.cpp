@@ -1,9 +1,11 @@
 #include "inline_token_icon.h"
 
 #include "ui/rp_widget.h"
+#include "ui/token_icon_pack.h"
 #include "qr/qr_generate.h"
 #include "styles/style_wallet.h"
 
+#include <crl/crl_async.h>
 #include <QtGui/QPainter>
 
 namespace Ui {
@@ -11,6 +13,8 @@ namespace {
 
 constexpr auto kShareQrSize = 768;
 constexpr auto kShareQrPadding = 16;
+constexpr auto kIconCacheLimit = 8 * 1024 * 1024;
+constexpr auto kQrCacheLimit = 16;
 
 const std::vector<std::pair<int, QString>> &TonVariants() {
   static const auto iconTon = std::vector<std::pair<int, QString>>{
@@ -79,14 +83,6 @@ QString ChooseVariant(const std::vector<std::pair<int, QString>> &variants, int
   return variants.back().second;
 }
 
-QString ChooseVariant(int desiredSize) {
-  return ChooseVariant(TonVariants(), desiredSize);
-}
-
-QString ChooseVariant(const QString &name, int desiredSize) {
-  return ChooseVariant(TokenVariants(name), desiredSize);
-}
-
 QImage CreateImage(const QString &variant, int size) {
   Expects(size > 0);
   auto result = QImage(":/gui/art/" + variant).scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
@@ -96,47 +92,231 @@ QImage CreateImage(const QString &variant, int size) {
   return result;
 }
 
-QImage TonImage(int size) {
-  return CreateImage(ChooseVariant(size), size);
-}
+using IconSource = std::variant<const std::vector<std::pair<int, QString>> *, const PackedTokenIcon *>;
 
-QImage TokenImage(const QString &name, int size) {
-  return CreateImage(ChooseVariant(name, size), size);
+IconSource SymbolSource(const Ton::Symbol &symbol) {
+  if (symbol.isTon()) {
+    return &TonVariants();
+  } else if (const auto packed = LookupPackedTokenIcon(symbol)) {
+    return packed;
+  }
+  return &TokenVariants(symbol.name());
 }
 
-QImage UnknownImage(int size) {
-  return CreateImage(ChooseVariant(UnknownTokenVariants(), size), size);
+// Thread-safe, used when rendering off the main thread
+QImage RenderSource(const IconSource &source, int size) {
+  return v::match(
+      source,
+      [&](const std::vector<std::pair<int, QString>> *variants) {
+        return CreateImage(ChooseVariant(*variants, size), size);
+      },
+      [&](const PackedTokenIcon *packed) { return RenderPackedTokenIcon(*packed, size); });
 }
 
-const QImage &Image(const Ton::Symbol &symbol) {
-  static const auto iconTon = TonImage(st::walletTokenIconSize * style::DevicePixelRatio());
-  static const auto iconUnknown = UnknownImage(st::walletTokenIconSize * style::DevicePixelRatio());
+// Process-wide cache of scaled icons, all tokens without own artwork share the unknown icon entries
+class IconCache final {
+ public:
+  [[nodiscard]] static IconCache &Instance() {
+    static auto result = IconCache();
+    return result;
+  }
+
+  [[nodiscard]] QImage image(const IconSource &source, int size) {
+    const auto key = Key{source, size};
+    const auto i = _images.find(key);
+    if (i != _images.end()) {
+      i->second.lastUsed = ++_counter;
+      return i->second.image;
+    }
+    auto result = RenderSource(source, size);
+    insert(key, result);
+    prepareStandardSizes(source);
+    return result;
+  }
+
+ private:
+  using Key = std::pair<IconSource, int>;
 
-  static const std::map<QString, QImage> tokenIcons = {
-      {"usdt", TokenImage("USDT", st::walletTokenIconSize * style::DevicePixelRatio())},
-      {"usdc", TokenImage("USDC", st::walletTokenIconSize * style::DevicePixelRatio())},
-      {"dai", TokenImage("DAI", st::walletTokenIconSize * style::DevicePixelRatio())},
-      {"wbtc", TokenImage("WBTC", st::walletTokenIconSize * style::DevicePixelRatio())},
-      {"weth", TokenImage("WETH", st::walletTokenIconSize * style::DevicePixelRatio())},
+  struct Entry {
+    QImage image;
+    uint64 lastUsed = 0;
   };
 
-  if (symbol.isTon()) {
-    return iconTon;
+  void insert(const Key &key, const QImage &image) {
+    if (_images.contains(key)) {
+      return;
+    }
+    _total += image.sizeInBytes();
+    _images.emplace(key, Entry{image, ++_counter});
+    while (_total > kIconCacheLimit && _images.size() > 1) {
+      const auto oldest = ranges::min_element(_images, ranges::less(), [](const auto &pair) {
+        return pair.second.lastUsed;
+      });
+      _total -= oldest->second.image.sizeInBytes();
+      _images.erase(oldest);
+    }
   }
 
-  const auto escaped = symbol.name().trimmed().toLower();
-  const auto it = tokenIcons.find(escaped);
-  if (it != tokenIcons.end()) {
-    return it->second;
-  } else {
-    return iconUnknown;
+  // Inline and list sizes are generated on a worker, so the first paint of other views is a cached blit
+  void prepareStandardSizes(const IconSource &source) {
+    if (!_prepared.emplace(source).second) {
+      return;
+    }
+    const auto ratio = style::DevicePixelRatio();
+    auto sizes = std::vector<int>{st::walletTokenIconSize * ratio, st::walletTokensListRowIconSize * ratio};
+    sizes.erase(ranges::remove_if(sizes, [&](int size) { return _images.contains(Key{source, size}); }),
+                end(sizes));
+    if (sizes.empty()) {
+      return;
+    }
+    crl::async([=] {
+      auto images = std::vector<std::pair<int, QImage>>();
+      images.reserve(sizes.size());
+      for (const auto size : sizes) {
+        images.emplace_back(size, RenderSource(source, size));
+      }
+      crl::on_main([=, images = std::move(images)] {
+        for (const auto &[size, image] : images) {
+          Instance().insert(Key{source, size}, image);
+        }
+      });
+    });
   }
+
+  base::flat_map<Key, Entry> _images;
+  base::flat_set<IconSource> _prepared;
+  int64 _total = 0;
+  uint64 _counter = 0;
+};
+
+QImage ScaledImage(const Ton::Symbol &symbol, int size) {
+  return RenderSource(SymbolSource(symbol), size);
+}
+
+QImage CachedImage(const Ton::Symbol &symbol, int size) {
+  return IconCache::Instance().image(SymbolSource(symbol), size);
+}
+
+QImage Image(const Ton::Symbol &symbol) {
+  return CachedImage(symbol, st::walletTokenIconSize * style::DevicePixelRatio());
 }
 
 void Paint(const Ton::Symbol &kind, QPainter &p, int x, int y) {
   p.drawImage(QRect(x, y, st::walletTokenIconSize, st::walletTokenIconSize), Image(kind));
 }
 
+QImage TokenQrExact(const Ton::Symbol &symbol, const Qr::Data &data, int pixel) {
+  return Qr::ReplaceCenter(Qr::Generate(data, pixel), ScaledImage(symbol, Qr::ReplaceSize(data, pixel)));
+}
+
+int TokenQrPixel(const Qr::Data &data, int pixel, int max) {
+  Expects(data.size > 0);
+
+  if (max > 0 && data.size * pixel > max) {
+    pixel = std::max(max / data.size, 1);
+  }
+  return pixel;
+}
+
+QImage TokenQrForShareExact(const Ton::Symbol &symbol, const Qr::Data &data) {
+  const auto size = (kShareQrSize - 2 * kShareQrPadding);
+  const auto image = TokenQrExact(symbol, data, size / data.size);
+  auto result = QImage(kShareQrPadding * 2 + image.width(), kShareQrPadding * 2 + image.height(),
+                       QImage::Format_ARGB32_Premultiplied);
+  result.fill(Qt::white);
+  {
+    auto p = QPainter(&result);
+    p.drawImage(kShareQrPadding, kShareQrPadding, image);
+  }
+  return result;
+}
+
+struct QrRequest {
+  Ton::Symbol symbol;
+  QString text;
+  int pixel = 0;  // Zero for the share image.
+  int max = 0;
+  int ratio = 1;
+};
+
+// Rendered codes are cached by (link, symbol, pixel size) and rendered on a worker thread.
+// Encoded data is kept separately, so the on-screen code and the share image encode the link once.
+class QrCache final {
+ public:
+  [[nodiscard]] static QrCache &Instance() {
+    static auto result = QrCache();
+    return result;
+  }
+
+  [[nodiscard]] const Qr::Data &encoded(const QString &text) {
+    const auto i = _encoded.find(text);
+    if (i != _encoded.end()) {
+      return i->second;
+    }
+    if (_encoded.size() >= kQrCacheLimit) {
+      _encoded.clear();
+    }
+    return _encoded.emplace(text, Qr::Encode(text)).first->second;
+  }
+
+  void request(const QrRequest &request, Fn<void(QImage)> done) {
+    const auto key = Key{request.symbol, request.text, request.pixel, request.max, request.ratio};
+    const auto i = _images.find(key);
+    if (i != _images.end()) {
+      i->second.lastUsed = ++_counter;
+      done(i->second.image);
+      return;
+    }
+    auto &waiters = _waiters[key];
+    waiters.push_back(std::move(done));
+    if (waiters.size() > 1) {
+      return;
+    }
+    crl::async([=, data = encoded(request.text)] {
+      auto image = (request.pixel > 0)
+                       ? TokenQrExact(request.symbol, data,
+                                      TokenQrPixel(data, request.pixel, request.max) * request.ratio)
+                       : TokenQrForShareExact(request.symbol, data);
+      crl::on_main([=, image = std::move(image)] { Instance().finish(key, image); });
+    });
+  }
+
+ private:
+  using Key = std::tuple<Ton::Symbol, QString, int, int, int>;
+
+  struct Entry {
+    QImage image;
+    uint64 lastUsed = 0;
+  };
+
+  void finish(const Key &key, const QImage &image) {
+    if (_images.size() >= kQrCacheLimit) {
+      _images.erase(ranges::min_element(_images, ranges::less(), [](const auto &pair) {
+        return pair.second.lastUsed;
+      }));
+    }
+    _images.emplace(key, Entry{image, ++_counter});
+    const auto waiters = _waiters.take(key);
+    if (waiters) {
+      for (const auto &done : *waiters) {
+        done(image);
+      }
+    }
+  }
+
+  base::flat_map<QString, Qr::Data> _encoded;
+  base::flat_map<Key, Entry> _images;
+  base::flat_map<Key, std::vector<Fn<void(QImage)>>> _waiters;
+  uint64 _counter = 0;
+};
+
+rpl::producer<QImage> QrValue(QrRequest &&request) {
+  return rpl::make_producer<QImage>([request = std::move(request)](const auto &consumer) {
+    QrCache::Instance().request(request, [=](const QImage &image) { consumer.put_next_copy(image); });
+    return rpl::lifetime();
+  });
+}
+
 }  // namespace
 
 void PaintInlineTokenIcon(const Ton::Symbol &symbol, QPainter &p, int x, int y, const style::font &font) {
@@ -144,11 +324,7 @@ void PaintInlineTokenIcon(const Ton::Symbol &symbol, QPainter &p, int x, int y,
 }
 
 QImage InlineTokenIcon(const Ton::Symbol &symbol, int size) {
-  if (symbol.isTon()) {
-    return TonImage(size);
-  } else {
-    return TokenImage(symbol.name(), size);
-  }
+  return CachedImage(symbol, size);
 }
 
 not_null<RpWidget *> CreateInlineTokenIcon(const Ton::Symbol &symbol, not_null<QWidget *> parent, int x, int y,
@@ -168,36 +344,26 @@ not_null<RpWidget *> CreateInlineTokenIcon(const Ton::Symbol &symbol, not_null<Q
   return result;
 }
 
-QImage TokenQrExact(const Ton::Symbol &symbol, const Qr::Data &data, int pixel) {
-  return Qr::ReplaceCenter(Qr::Generate(data, pixel), Ui::InlineTokenIcon(symbol, Qr::ReplaceSize(data, pixel)));
-}
-
-QImage TokenQr(const Ton::Symbol &symbol, const Qr::Data &data, int pixel, int max = 0) {
-  Expects(data.size > 0);
-
-  if (max > 0 && data.size * pixel > max) {
-    pixel = std::max(max / data.size, 1);
-  }
-  return TokenQrExact(symbol, data, pixel * style::DevicePixelRatio());
+int TokenQrSize(const QString &text, int pixel, int max) {
+  const auto &data = QrCache::Instance().encoded(text);
+  return data.size * TokenQrPixel(data, pixel, max);
 }
 
-QImage TokenQr(const Ton::Symbol &symbol, const QString &text, int pixel, int max) {
-  QImage img;
-  return TokenQr(symbol, Qr::Encode(text), pixel, max);
+rpl::producer<QImage> TokenQrValue(const Ton::Symbol &symbol, const QString &text, int pixel, int max) {
+  return QrValue({
+      .symbol = symbol,
+      .text = text,
+      .pixel = pixel,
+      .max = max,
+      .ratio = style::DevicePixelRatio(),
+  });
 }
 
-QImage TokenQrForShare(const Ton::Symbol &symbol, const QString &text) {
-  const auto data = Qr::Encode(text);
-  const auto size = (kShareQrSize - 2 * kShareQrPadding);
-  const auto image = TokenQrExact(symbol, data, size / data.size);
-  auto result = QImage(kShareQrPadding * 2 + image.width(), kShareQrPadding * 2 + image.height(),
-                       QImage::Format_ARGB32_Premultiplied);
-  result.fill(Qt::white);
-  {
-    auto p = QPainter(&result);
-    p.drawImage(kShareQrPadding, kShareQrPadding, image);
-  }
-  return result;
+rpl::producer<QImage> TokenQrForShareValue(const Ton::Symbol &symbol, const QString &text) {
+  return QrValue({
+      .symbol = symbol,
+      .text = text,
+  });
 }
 
 }  // namespace Ui
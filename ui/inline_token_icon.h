@@ -3,6 +3,8 @@
 #include "ui/style/style_core.h"
 #include "ton/ton_state.h"
 
+#include <rpl/producer.h>
+
 class QPainter;
 
 namespace Ui {
@@ -16,7 +18,9 @@ void PaintInlineTokenIcon(const Ton::Symbol &symbol, QPainter &p, int x, int y,
 not_null<RpWidget *> CreateInlineTokenIcon(const Ton::Symbol &symbol, not_null<QWidget *> parent, int x, int y,
                                            const style::font &font);
 
-[[nodiscard]] QImage TokenQr(const Ton::Symbol &token, const QString &text, int pixel, int max = 0);
-[[nodiscard]] QImage TokenQrForShare(const Ton::Symbol &token, const QString &text);
+[[nodiscard]] int TokenQrSize(const QString &text, int pixel, int max = 0);
+[[nodiscard]] rpl::producer<QImage> TokenQrValue(const Ton::Symbol &token, const QString &text, int pixel,
+                                                 int max = 0);
+[[nodiscard]] rpl::producer<QImage> TokenQrForShareValue(const Ton::Symbol &token, const QString &text);
 
 }  // namespace Ui
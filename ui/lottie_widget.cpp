@@ -9,26 +9,260 @@
 #include "ui/rp_widget.h"
 #include "ui/style/style_core.h"
 #include "lottie/lottie_single_player.h"
+#include "base/timer.h"
 
 #include <QtGui/QPainter>
 #include <QtCore/QFile>
+#include <zlib.h>
 
 namespace Ui {
 
-LottieAnimation::LottieAnimation(not_null<QWidget *> parent, const QByteArray &content)
+namespace {
+
+constexpr auto kSharedFramesLimit = 24 * 1024 * 1024;
+constexpr auto kUnpackChunk = 64 * 1024;
+constexpr auto kMaxUnpackedSize = 8 * 1024 * 1024;
+constexpr auto kThrottledFrameDelay = crl::time(100);
+
+// Background players render upcoming frames on the shared lottie renderer thread
+// into a small queue sized by the last frame request, the GUI thread only blits them.
+[[nodiscard]] Lottie::Quality ComputeQuality(LottieRendering rendering) {
+  return (rendering == LottieRendering::Synchronous) ? Lottie::Quality::Synchronous : Lottie::Quality::Default;
+}
+
+[[nodiscard]] QByteArray UnpackGzip(const QByteArray &bytes) {
+  auto stream = z_stream();
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(bytes.data()));
+  stream.avail_in = bytes.size();
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+    return bytes;
+  }
+  auto result = QByteArray();
+  auto status = Z_OK;
+  while (status == Z_OK && result.size() < kMaxUnpackedSize) {
+    const auto was = result.size();
+    result.resize(was + kUnpackChunk);
+    stream.next_out = reinterpret_cast<Bytef *>(result.data() + was);
+    stream.avail_out = kUnpackChunk;
+    status = inflate(&stream, Z_NO_FLUSH);
+    result.resize(was + kUnpackChunk - stream.avail_out);
+  }
+  inflateEnd(&stream);
+  return (status == Z_STREAM_END) ? result : bytes;
+}
+
+[[nodiscard]] int64 &SharedFramesBytes() {
+  static auto result = int64();
+  return result;
+}
+
+[[nodiscard]] rpl::variable<AnimationsMode> &AnimationsModeVariable() {
+  static auto result = rpl::variable<AnimationsMode>(AnimationsMode::Normal);
+  return result;
+}
+
+}  // namespace
+
+// Plays the resource once with a background player, keeping every rendered frame.
+// After the first loop the player is dropped and frames are replayed from memory,
+// unless the shared frames limit is hit, then the player keeps rendering.
+// Both advance only when some instance painted the current frame and requested the next one.
+class LottieSharedFrames final {
+ public:
+  LottieSharedFrames(const QString &resource, QSize size);
+  ~LottieSharedFrames();
+
+  [[nodiscard]] static std::shared_ptr<LottieSharedFrames> Acquire(const QString &resource, QSize size);
+
+  [[nodiscard]] QSize size() const;
+  [[nodiscard]] int framesCount() const;
+  [[nodiscard]] int index() const;
+  [[nodiscard]] QImage frame() const;
+  [[nodiscard]] rpl::producer<> updates() const;
+
+  void requestNext();
+
+ private:
+  void playerUpdated();
+  void storeFrame(const QImage &image);
+  void dropFrames();
+  void replayNext();
+
+  const QSize _size;
+  std::unique_ptr<Lottie::SinglePlayer> _player;
+  std::vector<QImage> _frames;
+  QImage _current;
+  int _index = -1;
+  int _stored = 0;
+  int64 _bytes = 0;
+  crl::time _frameDelay = 0;
+  bool _caching = true;
+  bool _framePending = false;
+  base::Timer _replayTimer;
+  rpl::event_stream<> _updates;
+  rpl::lifetime _playerLifetime;
+};
+
+LottieSharedFrames::LottieSharedFrames(const QString &resource, QSize size)
+    : _size(size)
+    , _player(std::make_unique<Lottie::SinglePlayer>(LottieFromResource(resource), Lottie::FrameRequest{size},
+                                                     Lottie::Quality::Default))
+    , _replayTimer([=] { replayNext(); }) {
+  _player->updates() | rpl::start_with_next([=](Lottie::Update update) { playerUpdated(); }, _playerLifetime);
+}
+
+LottieSharedFrames::~LottieSharedFrames() {
+  SharedFramesBytes() -= _bytes;
+}
+
+std::shared_ptr<LottieSharedFrames> LottieSharedFrames::Acquire(const QString &resource, QSize size) {
+  static auto map = base::flat_map<std::tuple<QString, int, int>, std::weak_ptr<LottieSharedFrames>>();
+
+  const auto key = std::make_tuple(resource, size.width(), size.height());
+  if (const auto result = map[key].lock()) {
+    return result;
+  }
+  for (auto i = map.begin(); i != map.end();) {
+    if (i->second.expired()) {
+      i = map.erase(i);
+    } else {
+      ++i;
+    }
+  }
+  auto result = std::make_shared<LottieSharedFrames>(resource, size);
+  map[key] = result;
+  return result;
+}
+
+QSize LottieSharedFrames::size() const {
+  return _size;
+}
+
+int LottieSharedFrames::framesCount() const {
+  return int(_frames.size());
+}
+
+int LottieSharedFrames::index() const {
+  return _index;
+}
+
+QImage LottieSharedFrames::frame() const {
+  return _current;
+}
+
+rpl::producer<> LottieSharedFrames::updates() const {
+  return _updates.events();
+}
+
+void LottieSharedFrames::playerUpdated() {
+  if (!_player->ready()) {
+    return;
+  }
+  const auto &information = _player->information();
+  if (_frames.empty()) {
+    _frames.resize(std::max(information.framesCount, 1));
+    _frameDelay = std::max(1000 / std::max(information.frameRate, 1), 1);
+  }
+  const auto frame = _player->frameInfo(Lottie::FrameRequest{_size});
+  _current = frame.image;
+  _index = frame.index;
+  _framePending = true;
+  storeFrame(frame.image);
+  _updates.fire({});
+}
+
+void LottieSharedFrames::requestNext() {
+  if (_player && _caching && _stored > 0 && _stored == framesCount()) {
+    _playerLifetime.destroy();
+    _player = nullptr;
+  }
+  if (_player) {
+    if (_framePending) {
+      _framePending = false;
+      _player->markFrameShown();
+    }
+  } else if (!_replayTimer.isActive()) {
+    _replayTimer.callOnce(_frameDelay);
+  }
+}
+
+void LottieSharedFrames::storeFrame(const QImage &image) {
+  if (!_caching || _index < 0 || _index >= framesCount() || !_frames[_index].isNull()) {
+    return;
+  }
+  const auto bytes = image.sizeInBytes();
+  if (SharedFramesBytes() + bytes > kSharedFramesLimit) {
+    dropFrames();
+    return;
+  }
+  _frames[_index] = image;
+  _bytes += bytes;
+  SharedFramesBytes() += bytes;
+  ++_stored;
+}
+
+void LottieSharedFrames::dropFrames() {
+  _caching = false;
+  SharedFramesBytes() -= _bytes;
+  _bytes = 0;
+  _stored = 0;
+  ranges::fill(_frames, QImage());
+}
+
+void LottieSharedFrames::replayNext() {
+  _index = (_index + 1) % framesCount();
+  _current = _frames[_index];
+  _updates.fire({});
+}
+
+LottieAnimation::LottieAnimation(not_null<QWidget *> parent, const QByteArray &content, LottieRendering rendering)
     : _widget(std::make_unique<RpWidget>(parent))
-    , _lottie(std::make_unique<Lottie::SinglePlayer>(content, Lottie::FrameRequest(), Lottie::Quality::Synchronous))
+    , _lottie(std::make_unique<Lottie::SinglePlayer>(content, Lottie::FrameRequest(), ComputeQuality(rendering)))
     , _framesInLoop(_lottie->ready() ? _lottie->information().framesCount : 0) {
-  _lottie->updates() | rpl::start_with_next([=](Lottie::Update update) { _widget->update(); }, _widget->lifetime());
+  _lottie->updates() | rpl::start_with_next(
+                          [=](Lottie::Update update) {
+                            if (!_framesInLoop && _lottie->ready()) {
+                              // Background players parse the content asynchronously.
+                              _framesInLoop = _lottie->information().framesCount;
+                              if (_stopOnLoop) {
+                                stopOnLoop(_stopOnLoop);
+                              }
+                            }
+                            _widget->update();
+                          },
+                          _widget->lifetime());
 
-  _widget->paintRequest() | rpl::filter([=] { return _lottie->ready(); }) |
-      rpl::start_with_next([=] { paintFrame(); }, _widget->lifetime());
+  setupPaint();
+}
 
-  _widget->show();
+LottieAnimation::LottieAnimation(not_null<QWidget *> parent, const LottieSharedResource &resource)
+    : _widget(std::make_unique<RpWidget>(parent))
+    , _resource(resource.name) {
+  setupPaint();
 }
 
 LottieAnimation::~LottieAnimation() = default;
 
+void LottieAnimation::setupPaint() {
+  _throttleTimer.setCallback([=] { _widget->update(); });
+
+  AnimationsModeValue()  //
+      | rpl::start_with_next([=] { _widget->update(); }, _widget->lifetime());
+
+  _widget->paintRequest() | rpl::filter([=] { return !_lottie || _lottie->ready(); }) |
+      rpl::start_with_next(
+          [=] {
+            if (_lottie) {
+              paintFrame();
+            } else {
+              paintSharedFrame();
+            }
+          },
+          _widget->lifetime());
+
+  _widget->show();
+}
+
 void LottieAnimation::setVisible(bool visible) {
   _widget->setVisible(visible);
 }
@@ -60,28 +294,103 @@ void LottieAnimation::paintFrame() {
   const auto pixelRatio = style::DevicePixelRatio();
   const auto request = Lottie::FrameRequest{_widget->size() * pixelRatio};
   const auto frame = _lottie->frameInfo(request);
-  const auto width = frame.image.width() / pixelRatio;
-  const auto height = frame.image.height() / pixelRatio;
-  const auto left = (_widget->width() - width) / 2;
-  const auto top = (_widget->height() - height) / 2;
-  const auto destination = QRect{left, top, width, height};
 
   auto p = QPainter(_widget.get());
-  p.setOpacity(_opacity);
-  p.drawImage(destination, frame.image);
+  paintImage(p, frame.image, request.resize);
 
   if (_startPlaying && frame.index == 0) {
     ++_loop;
   }
   const auto index = ((_loop - 1) * _framesInLoop + frame.index);
   if (_startPlaying && (!_stopOnFrame || index < _stopOnFrame)) {
-    if (!_lottie->markFrameShown() && frame.index == 0) {
+    const auto shown = readyForNextFrame() && _lottie->markFrameShown();
+    if (!shown && frame.index == 0) {
       // Didn't really skip that frame.
       --_loop;
     }
   }
 }
 
+void LottieAnimation::paintSharedFrame() {
+  const auto size = _widget->size() * style::DevicePixelRatio();
+  if (size.isEmpty()) {
+    return;
+  }
+  if (!_shared || _shared->size() != size) {
+    acquireSharedFrames(size);
+  }
+  auto p = QPainter(_widget.get());
+  if (!_frozen.isNull()) {
+    paintImage(p, _frozen, size);
+    return;
+  }
+  const auto index = _shared->index();
+  const auto image = _shared->frame();
+  paintImage(p, image, size);
+
+  if (!_startPlaying || index < 0) {
+    return;
+  }
+  if (index != _sharedIndex) {
+    if (index < _sharedIndex || _sharedIndex < 0) {
+      ++_loop;
+    }
+    _sharedIndex = index;
+    _framesInLoop = _shared->framesCount();
+    if (_stopOnLoop) {
+      _stopOnFrame = _stopOnLoop * _framesInLoop - 1;
+    }
+    if (_stopOnFrame && ((_loop - 1) * _framesInLoop + index) >= _stopOnFrame) {
+      _frozen = image;
+      _sharedLifetime.destroy();
+      return;
+    }
+  }
+  if (readyForNextFrame()) {
+    _shared->requestNext();
+  }
+}
+
+void LottieAnimation::acquireSharedFrames(QSize size) {
+  _sharedLifetime.destroy();
+  _shared = LottieSharedFrames::Acquire(_resource, size);
+  _shared->updates() | rpl::start_with_next([=] { _widget->update(); }, _sharedLifetime);
+}
+
+bool LottieAnimation::readyForNextFrame() {
+  const auto now = crl::now();
+  switch (CurrentAnimationsMode()) {
+    case AnimationsMode::Paused:
+      return false;
+    case AnimationsMode::Throttled:
+      if (const auto left = _lastFrameShown + kThrottledFrameDelay - now; left > 0) {
+        _throttleTimer.callOnce(left);
+        return false;
+      }
+      break;
+    case AnimationsMode::Normal:
+      break;
+  }
+  _lastFrameShown = now;
+  return true;
+}
+
+void LottieAnimation::paintImage(QPainter &p, const QImage &image, QSize request) {
+  if (image.isNull()) {
+    return;
+  }
+  // A frame prepared for the previous size is scaled until the new one is rendered.
+  const auto pixelRatio = style::DevicePixelRatio();
+  const auto size = image.size().scaled(request, Qt::KeepAspectRatio);
+  const auto width = size.width() / pixelRatio;
+  const auto height = size.height() / pixelRatio;
+  const auto left = (_widget->width() - width) / 2;
+  const auto top = (_widget->height() - height) / 2;
+
+  p.setOpacity(_opacity);
+  p.drawImage(QRect{left, top, width, height}, image);
+}
+
 void LottieAnimation::start() {
   _startPlaying = true;
   _widget->update();
@@ -98,10 +407,29 @@ void LottieAnimation::stopOnLoop(int loop) {
   }
 }
 
+void SetAnimationsMode(AnimationsMode mode) {
+  AnimationsModeVariable() = mode;
+}
+
+AnimationsMode CurrentAnimationsMode() {
+  return AnimationsModeVariable().current();
+}
+
+rpl::producer<AnimationsMode> AnimationsModeValue() {
+  return AnimationsModeVariable().value();
+}
+
 QByteArray LottieFromResource(const QString &name) {
+  static auto cache = base::flat_map<QString, QByteArray>();
+
+  const auto i = cache.find(name);
+  if (i != cache.end()) {
+    return i->second;
+  }
+  // Keep the unpacked json, so players don't gunzip the same resource again.
   auto file = QFile(":/gui/art/lottie/" + name + ".tgs");
   file.open(QIODevice::ReadOnly);
-  return file.readAll();
+  return cache.emplace(name, UnpackGzip(file.readAll())).first->second;
 }
 
 }  // namespace Ui
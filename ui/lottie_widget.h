@@ -6,6 +6,8 @@
 //
 #pragma once
 
+#include "base/timer.h"
+
 namespace Lottie {
 class SinglePlayer;
 struct Information;
@@ -14,10 +16,36 @@ struct Information;
 namespace Ui {
 
 class RpWidget;
+class LottieSharedFrames;
+
+enum class LottieRendering {
+  Synchronous,
+  Background,
+};
+
+enum class AnimationsMode {
+  Normal,
+  Throttled,
+  Paused,
+};
+
+// Central switch for all lottie animations, set from the window state.
+// Animations that are hidden or scrolled out of view pause on their own, they don't request frames without painting.
+void SetAnimationsMode(AnimationsMode mode);
+[[nodiscard]] AnimationsMode CurrentAnimationsMode();
+[[nodiscard]] rpl::producer<AnimationsMode> AnimationsModeValue();
+
+// Name of a looped resource whose frames are shared, see LottieAnimation.
+struct LottieSharedResource {
+  QString name;
+};
 
 class LottieAnimation final {
  public:
-  LottieAnimation(not_null<QWidget *> parent, const QByteArray &content);
+  LottieAnimation(not_null<QWidget *> parent, const QByteArray &content,
+                  LottieRendering rendering = LottieRendering::Background);
+  // Endlessly looped resource, frames are rendered once and shared by all instances of the same pixel size.
+  LottieAnimation(not_null<QWidget *> parent, const LottieSharedResource &resource);
   ~LottieAnimation();
 
   void setVisible(bool visible);
@@ -33,11 +61,25 @@ class LottieAnimation final {
   void stopOnLoop(int loop);
 
  private:
+  void setupPaint();
   void paintFrame();
+  void paintSharedFrame();
+  void paintImage(QPainter &p, const QImage &image, QSize request);
+  void acquireSharedFrames(QSize size);
+  [[nodiscard]] bool readyForNextFrame();
 
   const std::unique_ptr<RpWidget> _widget;
   const std::unique_ptr<Lottie::SinglePlayer> _lottie;
 
+  const QString _resource;
+  std::shared_ptr<LottieSharedFrames> _shared;
+  rpl::lifetime _sharedLifetime;
+  QImage _frozen;
+  int _sharedIndex = -1;
+
+  base::Timer _throttleTimer;
+  crl::time _lastFrameShown = 0;
+
   float64 _opacity = 1.;
   int _stopOnFrame = 0;
   int _stopOnLoop = 0;
@@ -0,0 +1,134 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "ui/token_icon_pack.h"
+
+#include "ton/ton_state.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+
+namespace Ui {
+namespace {
+
+constexpr auto kSheetBytesPerPixel = 4;
+constexpr auto kMaxSheetSide = 16384;
+
+struct Sheet {
+  std::unique_ptr<QFile> file;
+  QImage image;
+};
+
+struct Packs {
+  std::vector<Sheet> sheets;
+  std::vector<PackedTokenIcon> icons;
+  QHash<QString, int> index;
+};
+
+std::optional<Sheet> MapSheet(const QString &path, int width, int height) {
+  if (width <= 0 || height <= 0 || width > kMaxSheetSide || height > kMaxSheetSide) {
+    return std::nullopt;
+  }
+  auto file = std::make_unique<QFile>(path);
+  const auto bytesPerLine = width * kSheetBytesPerPixel;
+  const auto size = qint64(bytesPerLine) * height;
+  if (!file->open(QIODevice::ReadOnly) || file->size() != size) {
+    return std::nullopt;
+  }
+  const auto data = file->map(0, size);
+  if (!data) {
+    return std::nullopt;
+  }
+  auto image =
+      QImage(static_cast<const uchar *>(data), width, height, bytesPerLine, QImage::Format_ARGB32_Premultiplied);
+  return Sheet{std::move(file), std::move(image)};
+}
+
+void LoadPack(Packs &packs, const QString &indexPath, const QString &sheetPath) {
+  auto file = QFile(indexPath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+  const auto lines = QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+  if (lines.isEmpty()) {
+    return;
+  }
+  const auto header = lines.front().simplified().split(' ');
+  if (header.size() != 3 || header[0] != "sheet") {
+    return;
+  }
+  auto sheet = MapSheet(sheetPath, header[1].toInt(), header[2].toInt());
+  if (!sheet) {
+    return;
+  }
+  const auto bounds = sheet->image.rect();
+  const auto sheetIndex = int(packs.sheets.size());
+  packs.sheets.push_back(std::move(*sheet));
+
+  for (const auto &line : lines.mid(1)) {
+    const auto parts = line.simplified().split(' ');
+    if (parts.size() != 4) {
+      continue;
+    }
+    const auto size = parts[3].toInt();
+    const auto rect = QRect(parts[1].toInt(), parts[2].toInt(), size, size);
+    if (size <= 0 || !bounds.contains(rect)) {
+      continue;
+    }
+    const auto iconIndex = int(packs.icons.size());
+    packs.icons.push_back({.sheet = sheetIndex, .rect = rect});
+    for (const auto &key : parts[0].split(',', Qt::SkipEmptyParts)) {
+      const auto normalized = key.toLower();
+      if (!packs.index.contains(normalized)) {
+        packs.index.insert(normalized, iconIndex);
+      }
+    }
+  }
+}
+
+Packs LoadPacks() {
+  auto result = Packs();
+  const auto folder = QDir(QCoreApplication::applicationDirPath() + "/token_icons");
+  for (const auto &name : folder.entryList({"*.index"}, QDir::Files, QDir::Name)) {
+    const auto base = folder.filePath(name.chopped(6));
+    LoadPack(result, base + ".index", base + ".sheet");
+  }
+  return result;
+}
+
+const Packs &LoadedPacks() {
+  static const auto result = LoadPacks();
+  return result;
+}
+
+}  // namespace
+
+const PackedTokenIcon *LookupPackedTokenIcon(const Ton::Symbol &symbol) {
+  if (!symbol.isToken()) {
+    return nullptr;
+  }
+  const auto &packs = LoadedPacks();
+  if (packs.icons.empty()) {
+    return nullptr;
+  }
+  auto i = packs.index.find(symbol.rootContractAddress().toLower());
+  if (i == packs.index.end()) {
+    i = packs.index.find(symbol.name().trimmed().toLower());
+  }
+  return (i != packs.index.end()) ? &packs.icons[*i] : nullptr;
+}
+
+QImage RenderPackedTokenIcon(const PackedTokenIcon &icon, int size) {
+  const auto &sheet = LoadedPacks().sheets[icon.sheet].image;
+  const auto &rect = icon.rect;
+  const auto view = QImage(sheet.constBits() + rect.y() * sheet.bytesPerLine() + rect.x() * kSheetBytesPerPixel,
+                           rect.width(), rect.height(), sheet.bytesPerLine(), sheet.format());
+  return view.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+}  // namespace Ui
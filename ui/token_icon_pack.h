@@ -0,0 +1,37 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+class QImage;
+
+namespace Ton {
+class Symbol;
+}  // namespace Ton
+
+namespace Ui {
+
+// Token icon packs are pairs of files in one folder:
+//
+// <pack>.sheet - raw premultiplied ARGB32 pixels of the sprite sheet, mapped into memory as is.
+// <pack>.index - text index, first line "sheet <width> <height>",
+//                then one "<key>[,<key>...] <x> <y> <size>" line per icon,
+//                where keys are root token contract addresses or lowercase tickers.
+//
+// Packs are loaded once, on the first icon lookup, from the "token_icons"
+// folder next to the executable.
+
+struct PackedTokenIcon {
+  int sheet = 0;
+  QRect rect;
+};
+
+[[nodiscard]] const PackedTokenIcon *LookupPackedTokenIcon(const Ton::Symbol &symbol);
+
+// Thread-safe.
+[[nodiscard]] QImage RenderPackedTokenIcon(const PackedTokenIcon &icon, int size);
+
+}  // namespace Ui
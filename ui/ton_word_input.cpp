@@ -155,6 +155,18 @@ void TonWordInput::showErrorNoFocus() const {
   _word->showErrorNoFocus();
 }
 
+void TonWordInput::showCorrections(std::vector<QString> &&words) {
+  setFocus();
+  _word->showErrorNoFocus();
+  if (words.empty()) {
+    return;
+  }
+  if (!_suggestions) {
+    createSuggestionsWidget();
+  }
+  _suggestions->show(std::move(words));
+}
+
 rpl::producer<> TonWordInput::focused() const {
   return base::qt_signal_producer(_word.data(), &InputField::focused);
 }
@@ -41,6 +41,7 @@ class TonWordInput final {
   void setFocus() const;
   void showError() const;
   void showErrorNoFocus() const;
+  void showCorrections(std::vector<QString> &&words);
 
   [[nodiscard]] rpl::producer<> focused() const;
   [[nodiscard]] rpl::producer<> blurred() const;
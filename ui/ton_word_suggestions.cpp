@@ -28,7 +28,9 @@ TonWordSuggestions::TonWordSuggestions(not_null<QWidget *> parent)
                              },
                              _widget->lifetime());
 
-  _widget->paintRequest() | rpl::start_with_next([=](QRect clip) { paintRows(); }, _widget->lifetime());
+  _widget->paintRequest() | rpl::start_with_next([=](QRect clip) { paintRows(clip); }, _widget->lifetime());
+
+  _scroll->scrollTopChanges() | rpl::start_with_next([=] { _widget->update(); }, _widget->lifetime());
 
   _inner->setMouseTracking(true);
   _inner->events() | rpl::start_with_next(
@@ -38,7 +40,8 @@ TonWordSuggestions::TonWordSuggestions(not_null<QWidget *> parent)
                            } else if (e->type() == QEvent::MouseButtonPress) {
                              _pressed = _selected;
                            } else if (e->type() == QEvent::MouseButtonRelease) {
-                             _widget->update();
+                             updateRow(_pressed);
+                             updateRow(_selected);
                              if (std::exchange(_pressed, -1) == _selected) {
                                choose();
                              }
@@ -52,7 +55,16 @@ void TonWordSuggestions::show(std::vector<QString> &&words) {
     return;
   }
   _words = std::move(words);
+  _layouts.clear();
+  _layouts.reserve(_words.size());
+  for (const auto &word : _words) {
+    auto &layout = _layouts.emplace_back(word);
+    layout.setTextFormat(Qt::PlainText);
+    layout.prepare(QTransform(), st::normalFont->f);
+  }
+  _selected = -1;
   select(0);
+  _widget->update();
   const auto height =
       st::walletSuggestionsSkip * 2 + int(_words.size()) * st::walletSuggestionHeight + st::walletSuggestionShadowWidth;
   const auto outerHeight = std::min(height, st::walletSuggestionsHeightMax);
@@ -85,8 +97,28 @@ void TonWordSuggestions::select(int index) {
   if (_selected == index) {
     return;
   }
+  const auto was = highlighted();
   _selected = index;
-  _inner->update();
+  if (highlighted() != was) {
+    updateRow(was);
+    updateRow(highlighted());
+  }
+}
+
+int TonWordSuggestions::highlighted() const {
+  return (_pressed >= 0) ? _pressed : _selected;
+}
+
+QRect TonWordSuggestions::rowRect(int index) const {
+  const auto thickness = st::walletSuggestionShadowWidth;
+  return QRect(thickness, st::walletSuggestionsSkip + index * st::walletSuggestionHeight - _scroll->scrollTop(),
+               _widget->width() - 2 * thickness, st::walletSuggestionHeight);
+}
+
+void TonWordSuggestions::updateRow(int index) {
+  if (index >= 0 && index < int(_words.size())) {
+    _widget->update(rowRect(index));
+  }
 }
 
 void TonWordSuggestions::selectByMouse(QPoint position) {
@@ -111,52 +143,43 @@ void TonWordSuggestions::setGeometry(QPoint position, int width) {
   _inner->resize(width, _inner->height());
 }
 
-void TonWordSuggestions::paintRows() {
-  QPainter(_widget.get()).drawImage(0, 0, prepareFrame());
-}
-
-QImage TonWordSuggestions::prepareFrame() const {
-  const auto pixelRatio = style::DevicePixelRatio();
-  if (_frame.size() != _widget->size() * pixelRatio) {
-    _frame = QImage(_widget->size() * pixelRatio, QImage::Format_ARGB32_Premultiplied);
-  }
-  _frame.fill(st::windowBg->c);
-  _frame.setDevicePixelRatio(pixelRatio);
-  {
-    auto p = QPainter(&_frame);
-
-    const auto thickness = st::walletSuggestionShadowWidth;
-
-    p.setPen(st::windowFg);
-    p.setFont(st::normalFont);
-    auto index = 0;
-    const auto wordLeft = thickness;
-    auto wordTop = st::walletSuggestionsSkip - _scroll->scrollTop();
-    const auto wordWidth = _widget->width() - 2 * thickness;
-    const auto wordHeight = st::walletSuggestionHeight;
-    for (const auto &word : _words) {
-      if (index == (_pressed >= 0 ? _pressed : _selected)) {
-        p.fillRect(wordLeft, wordTop, wordWidth, wordHeight, st::windowBgOver);
-      }
-      p.drawText(wordLeft + st::walletSuggestionLeft, wordTop + st::walletSuggestionTop + st::normalFont->ascent, word);
-      wordTop += wordHeight;
-      ++index;
+// Only rows intersecting the clip are painted, selection changes invalidate just the two affected rows.
+void TonWordSuggestions::paintRows(QRect clip) {
+  auto p = QPainter(_widget.get());
+  p.fillRect(clip, st::windowBg);
+
+  const auto rowHeight = st::walletSuggestionHeight;
+  const auto shift = st::walletSuggestionsSkip - _scroll->scrollTop();
+  const auto from = std::max((clip.top() - shift) / rowHeight, 0);
+  const auto till = std::min((clip.top() + clip.height() - shift + rowHeight - 1) / rowHeight, int(_words.size()));
+
+  p.setPen(st::windowFg);
+  p.setFont(st::normalFont);
+  const auto selected = highlighted();
+  for (auto index = from; index < till; ++index) {
+    const auto rect = rowRect(index);
+    if (index == selected) {
+      p.fillRect(rect, st::windowBgOver);
     }
-
-    const auto radius = st::walletSuggestionsRadius;
-    const auto left = float64(thickness) / 2;
-    const auto top = -2. * radius;
-    const auto width = float64(_widget->width()) - thickness;
-    const auto height = float64(_widget->height()) - top + ((thickness / 2.) - thickness);
-
-    PainterHighQualityEnabler hq(p);
-    p.setBrush(Qt::NoBrush);
-    auto pen = st::defaultInputField.borderFg->p;
-    pen.setWidth(thickness);
-    p.setPen(pen);
-    p.drawRoundedRect(QRectF{left, top, width, height}, radius, radius);
+    p.drawStaticText(rect.x() + st::walletSuggestionLeft, rect.y() + st::walletSuggestionTop, _layouts[index]);
   }
-  return _frame;
+  paintBorder(p);
+}
+
+void TonWordSuggestions::paintBorder(QPainter &p) {
+  const auto thickness = st::walletSuggestionShadowWidth;
+  const auto radius = st::walletSuggestionsRadius;
+  const auto left = float64(thickness) / 2;
+  const auto top = -2. * radius;
+  const auto width = float64(_widget->width()) - thickness;
+  const auto height = float64(_widget->height()) - top + ((thickness / 2.) - thickness);
+
+  PainterHighQualityEnabler hq(p);
+  p.setBrush(Qt::NoBrush);
+  auto pen = st::defaultInputField.borderFg->p;
+  pen.setWidth(thickness);
+  p.setPen(pen);
+  p.drawRoundedRect(QRectF{left, top, width, height}, radius, radius);
 }
 
 rpl::producer<QString> TonWordSuggestions::chosen() const {
@@ -6,6 +6,10 @@
 //
 #pragma once
 
+#include <QtGui/QStaticText>
+
+class QPainter;
+
 namespace Ui {
 
 class RpWidget;
@@ -30,17 +34,20 @@ class TonWordSuggestions final {
   [[nodiscard]] rpl::lifetime &lifetime();
 
  private:
-  void paintRows();
+  void paintRows(QRect clip);
+  void paintBorder(QPainter &p);
   void ensureSelectedVisible();
   void selectByMouse(QPoint position);
-  [[nodiscard]] QImage prepareFrame() const;
+  void updateRow(int index);
+  [[nodiscard]] QRect rowRect(int index) const;
+  [[nodiscard]] int highlighted() const;
 
   const std::unique_ptr<RpWidget> _widget;
   const not_null<ScrollArea *> _scroll;
   const not_null<RpWidget *> _inner;
 
-  mutable QImage _frame;
   std::vector<QString> _words;
+  std::vector<QStaticText> _layouts;
   int _selected = -1;
   int _pressed = -1;
 
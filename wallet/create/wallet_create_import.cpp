@@ -7,6 +7,7 @@
 #include "wallet/create/wallet_create_import.h"
 
 #include "wallet/wallet_phrases.h"
+#include "wallet/wallet_words.h"
 #include "ui/text/text_utilities.h"
 #include "ui/widgets/buttons.h"
 #include "ui/rp_widget.h"
@@ -82,18 +83,21 @@ void Import::initControls(Fn<std::vector<QString>(QString)> wordsByPrefix) {
 
     word.pasted()  //
         | rpl::start_with_next(
-              [=](QString text) {
-                text = text.simplified();
-                int cnt = 0;
-                for (const auto &w : text.split(' ')) {
-                  if (index + cnt < count) {
-                    (*inputs)[index + cnt]->setText(w);
-                    (*inputs)[index + cnt]->setFocus();
-                    cnt++;
-                  } else {
-                    break;
+              [=](const QString &text) {
+                const auto phrase = CheckPhrase(text);
+                const auto pasted = std::min(int(phrase.size()), count - index);
+                auto invalid = -1;
+                for (auto i = 0; i != pasted; ++i) {
+                  (*inputs)[index + i]->setText(phrase[i].word);
+                  (*inputs)[index + i]->setFocus();
+                  if (!phrase[i].valid && invalid < 0) {
+                    invalid = i;
                   }
                 }
+                if (invalid >= 0) {
+                  auto hints = phrase[invalid].hints;
+                  (*inputs)[index + invalid]->showCorrections(std::move(hints));
+                }
               },
               lifetime());
 
@@ -15,7 +15,7 @@
 #include "wallet/create/wallet_create_ready.h"
 #include "wallet/wallet_phrases.h"
 #include "wallet/wallet_update_info.h"
-#include "ton/ton_wallet.h"
+#include "wallet/wallet_words.h"
 #include "ui/wrap/fade_wrap.h"
 #include "ui/widgets/buttons.h"
 #include "ui/text/text_utilities.h"
@@ -84,8 +84,7 @@ constexpr auto kWaitForWordsDelay = 30 * crl::time(1000);
 
 Manager::Manager(not_null<QWidget *> parent, UpdateInfo *updateInfo)
     : _content(std::make_unique<Ui::RpWidget>(parent))
-    , _backButton(std::in_place, _content.get(), object_ptr<Ui::IconButton>(_content.get(), st::walletStepBackButton))
-    , _validWords(Ton::Wallet::GetValidWords()) {
+    , _backButton(std::in_place, _content.get(), object_ptr<Ui::IconButton>(_content.get(), st::walletStepBackButton)) {
   _content->show();
   initButtons(updateInfo);
   showIntro();
@@ -149,7 +148,7 @@ void Manager::showWords(Direction direction) {
 void Manager::showCheck() {
   const auto indices = SelectRandomIndices(kCheckWordCount, _words.size());
 
-  auto check = std::make_unique<Check>([=](const QString &prefix) { return wordsByPrefix(prefix); }, indices);
+  auto check = std::make_unique<Check>(WordsByPrefix, indices);
 
   const auto raw = check.get();
 
@@ -232,7 +231,7 @@ void Manager::showStep(std::unique_ptr<Step> step, Direction direction, FnMut<vo
 }
 
 void Manager::showImport() {
-  auto step = std::make_unique<Import>([=](const QString &prefix) { return wordsByPrefix(prefix); });
+  auto step = std::make_unique<Import>(WordSuggestions);
 
   const auto raw = step.get();
 
@@ -319,34 +318,4 @@ rpl::lifetime &Manager::lifetime() {
   return _content->lifetime();
 }
 
-std::vector<QString> Manager::wordsByPrefix(const QString &word) const {
-  const auto adjusted = word.trimmed().toLower();
-  if (adjusted.isEmpty()) {
-    return {};
-  } else if (_validWords.empty()) {
-    return {word};
-  }
-  auto prefix = QString();
-  auto count = 0;
-  auto maxCount = 0;
-  for (const auto &validWord : _validWords) {
-    if (validWord.midRef(0, 3) != prefix) {
-      prefix = validWord.mid(0, 3);
-      count = 1;
-    } else {
-      ++count;
-    }
-    if (maxCount < count) {
-      maxCount = count;
-    }
-  }
-  auto result = std::vector<QString>();
-  const auto from = ranges::lower_bound(_validWords, adjusted);
-  const auto end = _validWords.end();
-  for (auto i = from; i != end && i->startsWith(adjusted); ++i) {
-    result.push_back(*i);
-  }
-  return result;
-}
-
 }  // namespace Wallet::Create
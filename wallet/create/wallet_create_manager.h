@@ -68,15 +68,12 @@ class Manager final {
  private:
   void showStep(std::unique_ptr<Step> step, Direction direction, FnMut<void()> next = nullptr,
                 FnMut<void()> back = nullptr);
-  [[nodiscard]] std::vector<QString> wordsByPrefix(const QString &word) const;
   void initButtons(UpdateInfo *updateInfo);
   void showImportFail();
   void setupUpdateButton(not_null<UpdateInfo *> info);
 
   const std::unique_ptr<Ui::RpWidget> _content;
   const base::unique_qptr<Ui::FadeWrap<Ui::IconButton>> _backButton;
-  const base::flat_set<QString> _validWords;
-  const Fn<std::vector<QString>(QString)> _wordsByPrefix;
 
   base::unique_qptr<Ui::RoundButton> _updateButton;
 
@@ -105,27 +105,79 @@ not_null<Ui::InputField *> CreateCustodiansInput(not_null<QWidget *> parent, con
   return result;
 }
 
-const QRegExp &CustodiansListRegex() {
-  static const QRegExp regex{R"((\ |\,|\;|\.|\n|\t))"};
-  return regex;
+struct ParsedCustodians {
+  base::flat_set<QByteArray> keys;
+  int errorPosition = -1;
+  int errorLength = 0;
+
+  [[nodiscard]] bool valid() const {
+    return errorPosition < 0 && !keys.empty();
+  }
+};
+
+[[nodiscard]] bool IsCustodiansSeparator(QChar ch) {
+  switch (ch.unicode()) {
+    case ' ':
+    case ',':
+    case ';':
+    case '.':
+    case '\n':
+    case '\t':
+      return true;
+    default:
+      return false;
+  }
 }
 
-std::optional<base::flat_set<QByteArray>> ParseCustodiansList(const QString &value) {
-  constexpr auto pubkeyLength = 64;
-  base::flat_set<QByteArray> result;
-  const auto list = value.split(CustodiansListRegex(), QString::SplitBehavior::SkipEmptyParts);
-  if (list.empty()) {
-    return std::nullopt;
+[[nodiscard]] int HexDigitValue(QChar ch) {
+  const auto code = ch.unicode();
+  if (code >= '0' && code <= '9') {
+    return code - '0';
+  } else if (code >= 'a' && code <= 'f') {
+    return code - 'a' + 10;
+  } else if (code >= 'A' && code <= 'F') {
+    return code - 'A' + 10;
   }
-  for (const auto &item : list) {
-    if (item.size() != pubkeyLength) {
-      return std::nullopt;
+  return -1;
+}
+
+ParsedCustodians ParseCustodiansList(const QString &value) {
+  constexpr auto pubkeyLength = 64;
+
+  auto result = ParsedCustodians();
+  auto decoded = QByteArray(pubkeyLength / 2, Qt::Uninitialized);
+
+  const auto size = value.size();
+  const auto data = value.constData();
+  for (auto i = 0; i < size;) {
+    if (IsCustodiansSeparator(data[i])) {
+      ++i;
+      continue;
     }
-    auto decoded = QByteArray::fromHex(item.toUtf8());
-    if (decoded.size() != pubkeyLength / 2) {
-      return std::nullopt;
+
+    const auto start = i;
+    auto valid = true;
+    while (i < size && !IsCustodiansSeparator(data[i])) {
+      const auto length = i - start;
+      if (valid && length < pubkeyLength) {
+        const auto digit = HexDigitValue(data[i]);
+        if (digit < 0) {
+          valid = false;
+        } else if (length % 2) {
+          decoded[length / 2] = char((uchar(decoded[length / 2]) << 4) | digit);
+        } else {
+          decoded[length / 2] = char(digit);
+        }
+      }
+      ++i;
     }
-    result.emplace(std::move(decoded));
+
+    if (!valid || i - start != pubkeyLength) {
+      result.errorPosition = start;
+      result.errorLength = i - start;
+      return result;
+    }
+    result.keys.emplace(decoded);
   }
   return result;
 }
@@ -513,15 +565,27 @@ void DeployMultisigBox(not_null<Ui::GenericBox *> box, const Ton::MultisigInitia
     *custodianCount = std::nullopt;
   };
 
+  // Text of the last successfully applied list, skips reparsing on submit
+  const auto parsedText = box->lifetime().make_state<std::optional<QString>>(defaultCustodian);
+  const auto errorPosition = box->lifetime().make_state<std::pair<int, int>>(-1, 0);
+
   auto checkList = [=]() -> std::optional<base::flat_set<QByteArray> *> {
-    auto list = ParseCustodiansList(custodiansList->getLastText());
-    if (list.has_value()) {
-      const auto count = list->size();
+    const auto text = custodiansList->getLastText();
+    if (parsedText->has_value() && **parsedText == text) {
+      return custodians;
+    }
+    *parsedText = std::nullopt;
+
+    auto list = ParseCustodiansList(text);
+    *errorPosition = std::make_pair(list.errorPosition, list.errorLength);
+    if (list.valid()) {
+      const auto count = list.keys.size();
       const auto tooMuch = count > Ton::kMaxMultisigCustodianCount;
       maxCustodianCountLabel->setTextColorOverride(tooMuch ? std::make_optional(st::boxTextFgError->c) : std::nullopt);
       if (!tooMuch) {
-        *custodians = std::move(*list);
-        *custodianCount = count;
+        *custodians = std::move(list.keys);
+        *custodianCount = static_cast<int>(count);
+        *parsedText = text;
         return custodians;
       }
     }
@@ -529,6 +593,18 @@ void DeployMultisigBox(not_null<Ui::GenericBox *> box, const Ton::MultisigInitia
     return std::nullopt;
   };
 
+  const auto showListError = [=] {
+    const auto [position, length] = *errorPosition;
+    if (position < 0) {
+      return;
+    }
+    custodiansList->setFocusFast();
+    auto cursor = custodiansList->textCursor();
+    cursor.setPosition(position);
+    cursor.setPosition(position + length, QTextCursor::KeepAnchor);
+    custodiansList->setTextCursor(cursor);
+  };
+
   Ui::Connect(custodiansList, &Ui::InputField::changed,
               [=] { Ui::PostponeCall(custodiansList, [=] { checkList(); }); });
 
@@ -544,7 +620,7 @@ void DeployMultisigBox(not_null<Ui::GenericBox *> box, const Ton::MultisigInitia
 
     const auto owners = checkList();
     if (!owners.has_value()) {
-      return;
+      return showListError();
     }
     const auto ownerCount = (*owners)->size();
     if (collected.requiredConfirmations > ownerCount) {
@@ -1,6 +1,7 @@
 #include "wallet_assets_list.h"
 
 #include "wallet/wallet_common.h"
+#include "wallet/wallet_derive.h"
 #include "ui/painter.h"
 #include "ui/widgets/labels.h"
 #include "ui/widgets/popup_menu.h"
@@ -421,7 +422,7 @@ bool AssetsList::mergeListChanged(AssetsListState &&data) {
 }
 
 rpl::producer<AssetsListState> MakeTokensListState(rpl::producer<Ton::WalletViewerState> state) {
-  return std::move(state) | rpl::map([=](const Ton::WalletViewerState &data) {
+  return DeriveAsync<AssetsListState>(std::move(state), [](const Ton::WalletViewerState &data) {
            const auto &account = data.wallet.account;
            const auto unlockedTonBalance = account.fullBalance - account.lockedBalance;
 
@@ -476,7 +477,16 @@ rpl::producer<AssetsListState> MakeTokensListState(rpl::producer<Ton::WalletView
                  }));
            }
            return result;
-         });
+         }) |
+         rpl::distinct_until_changed();
+}
+
+bool operator==(const AssetsListState &a, const AssetsListState &b) {
+  return a.items == b.items;
+}
+
+bool operator!=(const AssetsListState &a, const AssetsListState &b) {
+  return !(a == b);
 }
 
 bool operator==(const AssetItem &a, const AssetItem &b) {
@@ -46,6 +46,9 @@ struct AssetsListState {
   std::vector<AssetItem> items;
 };
 
+bool operator==(const AssetsListState &a, const AssetsListState &b);
+bool operator!=(const AssetsListState &a, const AssetsListState &b);
+
 class AssetsListRow;
 
 class AssetsList final {
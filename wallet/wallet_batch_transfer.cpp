@@ -0,0 +1,561 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "wallet/wallet_batch_transfer.h"
+
+#include "wallet/wallet_phrases.h"
+#include "wallet/wallet_send_grams.h"
+#include "ui/widgets/labels.h"
+#include "ui/widgets/buttons.h"
+#include "ui/widgets/checkbox.h"
+#include "ton/ton_wallet.h"
+#include "styles/style_wallet.h"
+#include "styles/style_layers.h"
+#include "styles/style_widgets.h"
+
+namespace Wallet {
+namespace {
+
+constexpr auto kMaxParallelChecks = 4;
+constexpr auto kShortAddressPart = 8;
+
+enum class ButtonMode {
+  Send,
+  Stop,
+  Close,
+};
+
+[[nodiscard]] QStringList SplitFields(const QString &line, QChar separator) {
+  auto result = QStringList();
+  auto field = QString();
+  auto quoted = false;
+  for (auto i = 0; i != line.size(); ++i) {
+    const auto ch = line[i];
+    if (quoted) {
+      if (ch != '"') {
+        field.append(ch);
+      } else if (i + 1 < line.size() && line[i + 1] == '"') {
+        field.append(ch);
+        ++i;
+      } else {
+        quoted = false;
+      }
+    } else if (ch == '"') {
+      quoted = true;
+    } else if (ch == separator) {
+      result.push_back(field.trimmed());
+      field.clear();
+    } else {
+      field.append(ch);
+    }
+  }
+  result.push_back(field.trimmed());
+  return result;
+}
+
+[[nodiscard]] std::optional<QString> ParseRecipient(const QString &text) {
+  return v::match(
+      ParseAddress(text),
+      [](const ParsedAddressTon &parsed) -> std::optional<QString> {
+        if (!Ton::Wallet::CheckAddress(parsed.address)) {
+          return std::nullopt;
+        }
+        return parsed.address;
+      },
+      [](const ParsedAddressEth &) -> std::optional<QString> { return std::nullopt; });
+}
+
+[[nodiscard]] QString ShortAddress(const QString &address) {
+  if (address.size() <= 3 * kShortAddressPart) {
+    return address;
+  }
+  return address.mid(0, kShortAddressPart) + QString::fromUtf8("\xe2\x80\xa6") + address.right(kShortAddressPart);
+}
+
+[[nodiscard]] QString InvalidText(InvoiceField field) {
+  switch (field) {
+    case InvoiceField::Address:
+      return ph::lng_wallet_batch_transfer_invalid_address(ph::now);
+    case InvoiceField::Amount:
+      return ph::lng_wallet_batch_transfer_invalid_amount(ph::now);
+    case InvoiceField::Comment:
+      return ph::lng_wallet_batch_transfer_invalid_comment(ph::now);
+    case InvoiceField::CallbackAddress:
+      break;
+  }
+  Unexpected("Field in InvalidText.");
+}
+
+[[nodiscard]] QString StatusText(const BatchTransferRow &row, const BatchTransferRowState &state) {
+  switch (state.status) {
+    case BatchTransferStatus::Invalid:
+      return InvalidText(*row.invalid);
+    case BatchTransferStatus::Checking:
+      return ph::lng_wallet_batch_transfer_checking(ph::now);
+    case BatchTransferStatus::Checked:
+      return ph::lng_wallet_batch_transfer_fee(ph::now).replace("{amount}",
+                                                                FormatAmount(state.fee, Ton::Symbol::ton()).full);
+    case BatchTransferStatus::Sending:
+      return ph::lng_wallet_batch_transfer_sending(ph::now);
+    case BatchTransferStatus::Sent:
+      return ph::lng_wallet_batch_transfer_sent(ph::now);
+    case BatchTransferStatus::Failed:
+      return ph::lng_wallet_batch_transfer_failed(ph::now).replace("{error}", state.error);
+  }
+  Unexpected("Status in StatusText.");
+}
+
+[[nodiscard]] QString RowText(const BatchTransferRow &row, const BatchTransferRowState &state,
+                              const Ton::Symbol &symbol) {
+  const auto amount = row.invalid ? QString("-") : FormatAmount(row.amount, symbol).full;
+  return QString("%1. %2 \xe2\x80\x94 %3 \xe2\x80\x94 %4")
+      .arg(row.line)
+      .arg(row.invalid == InvoiceField::Address ? row.address : ShortAddress(row.address))
+      .arg(amount)
+      .arg(StatusText(row, state));
+}
+
+[[nodiscard]] QString SummaryText(const BatchTransferProgress &progress, const Ton::Symbol &symbol) {
+  return ph::lng_wallet_batch_transfer_summary(ph::now)
+      .replace("{count}", QString::number(progress.total))
+      .replace("{amount}", FormatAmount(progress.amount, symbol).full)
+      .replace("{checked}", QString::number(progress.total - progress.checking))
+      .replace("{sent}", QString::number(progress.sent))
+      .replace("{failed}", QString::number(progress.failed))
+      .replace("{fees}", FormatAmount(progress.fees, Ton::Symbol::ton()).full);
+}
+
+[[nodiscard]] bool HasShortfall(const BatchTransferProgress &progress) {
+  return (progress.shortfall.asset > 0) || (progress.shortfall.ton > 0);
+}
+
+[[nodiscard]] QString ShortfallText(const BatchTransferProgress &progress, const Ton::Symbol &symbol) {
+  auto missing = QStringList();
+  if (progress.shortfall.asset > 0) {
+    missing.push_back(FormatAmount(progress.shortfall.asset, symbol).full);
+  }
+  if (progress.shortfall.ton > 0) {
+    missing.push_back(FormatAmount(progress.shortfall.ton, Ton::Symbol::ton()).full);
+  }
+  if (missing.isEmpty()) {
+    return QString();
+  }
+  return ph::lng_wallet_batch_transfer_shortfall(ph::now).replace("{amount}", missing.join(" + "));
+}
+
+[[nodiscard]] bool IsSelectable(BatchTransferStatus status) {
+  return (status == BatchTransferStatus::Checking) || (status == BatchTransferStatus::Checked);
+}
+
+[[nodiscard]] ButtonMode ComputeButtonMode(const BatchTransferProgress &progress) {
+  if (progress.sending || progress.waiting > 0) {
+    return ButtonMode::Stop;
+  } else if (progress.ready > 0 || progress.checking > 0) {
+    return ButtonMode::Send;
+  }
+  return ButtonMode::Close;
+}
+
+}  // namespace
+
+std::vector<BatchTransferRow> ParseBatchTransfer(const QByteArray &content, const Ton::Symbol &symbol) {
+  const auto lines = QString::fromUtf8(content).split('\n');
+
+  auto result = std::vector<BatchTransferRow>();
+  auto separator = std::optional<QChar>();
+  for (auto i = 0; i != lines.size(); ++i) {
+    const auto line = lines[i].trimmed();
+    if (line.isEmpty() || line.startsWith('#')) {
+      continue;
+    }
+    const auto first = !separator.has_value();
+    if (first) {
+      separator = line.contains(';') ? QChar(';') : QChar(',');
+    }
+    const auto fields = SplitFields(line, *separator);
+
+    auto row = BatchTransferRow{
+        .line = i + 1,
+        .address = fields[0],
+        .comment = fields.mid(2).join(*separator),
+    };
+    const auto address = ParseRecipient(fields[0]);
+    const auto amount = (fields.size() > 1) ? ParseAmountString(fields[1], symbol.decimals()) : std::nullopt;
+    if (first && !address && !amount) {
+      // Header line.
+      continue;
+    }
+    if (!address) {
+      row.invalid = InvoiceField::Address;
+    } else if (!amount || *amount <= 0 || (symbol.isTon() && *amount > std::numeric_limits<int64>::max())) {
+      row.address = *address;
+      row.invalid = InvoiceField::Amount;
+    } else if (Utf8Length(row.comment) > kMaxCommentLength || (!symbol.isTon() && !row.comment.isEmpty())) {
+      row.address = *address;
+      row.invalid = InvoiceField::Comment;
+    } else {
+      row.address = *address;
+      row.amount = *amount;
+    }
+    result.push_back(std::move(row));
+  }
+  return result;
+}
+
+BatchTransfer::BatchTransfer(std::vector<BatchTransferRow> rows, const Ton::Symbol &symbol, Check check)
+    : _rows(std::move(rows))  //
+    , _feesFromAmount(symbol.isTon())
+    , _check(std::move(check))
+    , _states(_rows.size())
+    , _attempts(_rows.size()) {
+  for (auto i = 0, count = int(_rows.size()); i != count; ++i) {
+    if (_rows[i].invalid) {
+      _states[i].status = BatchTransferStatus::Invalid;
+    }
+  }
+}
+
+void BatchTransfer::start() {
+  checkNext();
+}
+
+void BatchTransfer::setFunds(const BatchTransferFunds &funds) {
+  _funds = funds;
+  _progressChanges.fire(progress());
+}
+
+void BatchTransfer::checkNext() {
+  const auto count = int(_rows.size());
+  while (_checking < kMaxParallelChecks && _nextCheck < count) {
+    const auto index = _nextCheck++;
+    if (_states[index].status != BatchTransferStatus::Checking) {
+      continue;
+    }
+    ++_checking;
+    _check(index, crl::guard(this, [=](BatchTransferChecked result) { checked(index, std::move(result)); }));
+  }
+}
+
+void BatchTransfer::checked(int index, BatchTransferChecked &&result) {
+  --_checking;
+
+  auto &state = _states[index];
+  if (result.error.isEmpty()) {
+    state.status = BatchTransferStatus::Checked;
+    state.invoice = std::move(result.invoice);
+    state.fee = result.fee;
+  } else {
+    state.status = BatchTransferStatus::Failed;
+    state.error = std::move(result.error);
+  }
+  updated(index);
+
+  checkNext();
+  if (_sending && _inFlight < 0) {
+    sendNext();
+  }
+}
+
+void BatchTransfer::send(Send send) {
+  _send = std::move(send);
+  resume();
+}
+
+bool BatchTransfer::resume() {
+  if (!_send) {
+    return false;
+  }
+  if (!_sending) {
+    _sending = true;
+    _progressChanges.fire(progress());
+  }
+  if (_inFlight < 0) {
+    sendNext();
+  }
+  return true;
+}
+
+void BatchTransfer::stop() {
+  if (_sending) {
+    _sending = false;
+    _progressChanges.fire(progress());
+  }
+}
+
+void BatchTransfer::setSkipped(int index, bool skipped) {
+  auto &state = _states[index];
+  if (state.skipped == skipped || !IsSelectable(state.status)) {
+    return;
+  }
+  state.skipped = skipped;
+  if (!skipped) {
+    _nextSend = std::min(_nextSend, index);
+  }
+  updated(index);
+
+  if (_sending && _inFlight < 0) {
+    sendNext();
+  }
+}
+
+void BatchTransfer::interrupt() {
+  if (_inFlight >= 0) {
+    const auto index = std::exchange(_inFlight, -1);
+    ++_attempts[index];
+    _nextSend = std::min(_nextSend, index);
+    _states[index].status = BatchTransferStatus::Checked;
+    updated(index);
+  }
+  _send = nullptr;
+  stop();
+}
+
+void BatchTransfer::sendNext() {
+  Expects(_inFlight < 0);
+
+  if (HasShortfall(progress())) {
+    stop();
+    return;
+  }
+  const auto count = int(_rows.size());
+  for (; _nextSend != count; ++_nextSend) {
+    const auto status = _states[_nextSend].status;
+    if (status == BatchTransferStatus::Checking) {
+      // Keep the file order, continue when the check is done.
+      return;
+    } else if (status == BatchTransferStatus::Checked && !_states[_nextSend].skipped) {
+      break;
+    }
+  }
+  if (_nextSend == count) {
+    stop();
+    return;
+  }
+
+  const auto index = _inFlight = _nextSend++;
+  const auto attempt = _attempts[index];
+  _states[index].status = BatchTransferStatus::Sending;
+  updated(index);
+
+  const auto current = [=] { return _attempts[index] == attempt; };
+  _send(
+      _states[index].invoice,
+      crl::guard(this,
+                 [=] {
+                   if (current()) {
+                     accepted(index);
+                   }
+                 }),
+      crl::guard(this, [=](std::optional<QString> error) {
+        if (current()) {
+          sent(index, std::move(error));
+        }
+      }));
+}
+
+void BatchTransfer::accepted(int index) {
+  if (_inFlight != index) {
+    return;
+  }
+  _inFlight = -1;
+  if (_sending) {
+    sendNext();
+  }
+}
+
+void BatchTransfer::sent(int index, std::optional<QString> &&error) {
+  auto &state = _states[index];
+  if (state.status != BatchTransferStatus::Sending) {
+    return;
+  }
+  if (error) {
+    state.status = BatchTransferStatus::Failed;
+    state.error = std::move(*error);
+  } else {
+    state.status = BatchTransferStatus::Sent;
+  }
+  updated(index);
+
+  accepted(index);
+}
+
+void BatchTransfer::updated(int index) {
+  _rowUpdates.fire_copy(index);
+  _progressChanges.fire(progress());
+}
+
+const std::vector<BatchTransferRow> &BatchTransfer::rows() const {
+  return _rows;
+}
+
+const BatchTransferRowState &BatchTransfer::state(int index) const {
+  Expects(index >= 0 && index < int(_states.size()));
+
+  return _states[index];
+}
+
+BatchTransferProgress BatchTransfer::progress() const {
+  auto result = BatchTransferProgress{.sending = _sending};
+  for (auto i = 0, count = int(_rows.size()); i != count; ++i) {
+    const auto &state = _states[i];
+    switch (state.status) {
+      case BatchTransferStatus::Invalid:
+        continue;
+      case BatchTransferStatus::Checking:
+        ++result.checking;
+        if (!state.skipped) {
+          result.readyAmount += _rows[i].amount;
+        }
+        break;
+      case BatchTransferStatus::Checked:
+        if (!state.skipped) {
+          ++result.ready;
+          result.fees += state.fee;
+          result.readyAmount += _rows[i].amount;
+          result.readyFees += state.fee;
+        }
+        break;
+      case BatchTransferStatus::Sending:
+        ++result.waiting;
+        result.fees += state.fee;
+        break;
+      case BatchTransferStatus::Sent:
+        ++result.sent;
+        result.fees += state.fee;
+        break;
+      case BatchTransferStatus::Failed:
+        ++result.failed;
+        break;
+    }
+    ++result.total;
+    if (!state.skipped) {
+      result.amount += _rows[i].amount;
+    }
+  }
+  // Sent rows are already taken from the balance, so only the rest are compared with it.
+  if (_funds) {
+    const auto ton = [&](int128 required) { return std::max(required - _funds->ton, int128()); };
+    if (_feesFromAmount) {
+      result.shortfall.ton = ton(result.readyAmount + result.readyFees);
+    } else {
+      result.shortfall.asset = std::max(result.readyAmount - _funds->asset, int128());
+      result.shortfall.ton = ton(result.readyFees);
+    }
+  }
+  return result;
+}
+
+rpl::producer<int> BatchTransfer::rowUpdates() const {
+  return _rowUpdates.events();
+}
+
+rpl::producer<BatchTransferProgress> BatchTransfer::progressValue() const {
+  return _progressChanges.events_starting_with(progress());
+}
+
+rpl::lifetime &BatchTransfer::lifetime() {
+  return _lifetime;
+}
+
+void BatchTransferBox(not_null<Ui::GenericBox *> box, BatchTransferKind kind, const Ton::Symbol &symbol,
+                      const std::shared_ptr<BatchTransfer> &transfer, rpl::producer<BatchTransferFunds> funds,
+                      const Fn<void()> &askPassword) {
+  const auto raw = transfer.get();
+  box->lifetime().add([transfer] {});
+
+  std::move(funds)  //
+      | rpl::start_with_next([=](const BatchTransferFunds &funds) { raw->setFunds(funds); }, box->lifetime());
+  const auto missing = box->lifetime().make_state<rpl::variable<QString>>(
+      raw->progressValue() | rpl::map([=](const BatchTransferProgress &progress) {
+        return ShortfallText(progress, symbol);
+      }));
+
+  const auto confirmations = (kind == BatchTransferKind::MultisigConfirmation);
+  box->setTitle(confirmations ? ph::lng_wallet_multisig_confirm_batch_title() : ph::lng_wallet_batch_transfer_title());
+  box->setStyle(st::walletBox);
+  box->setCloseByOutsideClick(false);
+
+  box->addTopButton(st::boxTitleClose, [=] { box->closeBox(); });
+
+  const auto summary = box->addRow(  //
+      object_ptr<Ui::FlatLabel>(box, QString(), st::walletLabel), st::walletBatchTransferSummaryPadding);
+
+  const auto &rows = raw->rows();
+  auto checkboxes = std::vector<not_null<Ui::Checkbox *>>();
+  checkboxes.reserve(rows.size());
+  for (auto i = 0, count = int(rows.size()); i != count; ++i) {
+    const auto &state = raw->state(i);
+    const auto checkbox = box->addRow(  //
+        object_ptr<Ui::Checkbox>(box, RowText(rows[i], state, symbol),
+                                 !state.skipped && (state.status != BatchTransferStatus::Invalid),
+                                 st::defaultBoxCheckbox),
+        st::walletBatchTransferRowPadding);
+    checkbox->setDisabled(!IsSelectable(state.status));
+    checkbox->checkedChanges()  //
+        | rpl::start_with_next([=](bool checked) { raw->setSkipped(i, !checked); }, checkbox->lifetime());
+    checkboxes.push_back(checkbox);
+  }
+
+  raw->rowUpdates()  //
+      | rpl::start_with_next(
+            [=, checkboxes = std::move(checkboxes)](int index) {
+              const auto &state = raw->state(index);
+              const auto checkbox = checkboxes[index];
+              checkbox->setText(RowText(raw->rows()[index], state, symbol));
+              checkbox->setDisabled(!IsSelectable(state.status));
+            },
+            box->lifetime());
+
+  rpl::combine(raw->progressValue(), missing->value())  //
+      | rpl::start_with_next(
+            [=](const BatchTransferProgress &progress, const QString &missing) {
+              const auto text = SummaryText(progress, symbol);
+              summary->setText(missing.isEmpty() ? text : (text + '\n' + missing));
+            },
+            box->lifetime());
+
+  raw->progressValue()                 //
+      | rpl::map(ComputeButtonMode)    //
+      | rpl::distinct_until_changed()  //
+      | rpl::start_with_next(
+            [=](ButtonMode mode) {
+              box->clearButtons();
+              switch (mode) {
+                case ButtonMode::Send: {
+                  auto text = raw->progressValue() | rpl::map([=](const BatchTransferProgress &progress) {
+                                const auto &phrase = confirmations ? ph::lng_wallet_multisig_confirm_batch_button
+                                                                   : ph::lng_wallet_batch_transfer_button;
+                                return phrase(ph::now).replace("{count}", QString::number(progress.ready));
+                              });
+                  const auto send = [=] {
+                    if (raw->progress().ready > 0 && missing->current().isEmpty() && !raw->resume()) {
+                      askPassword();
+                    }
+                  };
+                  const auto button = box->addButton(std::move(text), send, st::walletBottomButton);
+                  button->setTextTransform(Ui::RoundButton::TextTransform::NoTransform);
+                  missing->value()  //
+                      | rpl::start_with_next([=](const QString &missing) { button->setDisabled(!missing.isEmpty()); },
+                                             button->lifetime());
+                } break;
+                case ButtonMode::Stop:
+                  box->addButton(
+                         ph::lng_wallet_batch_transfer_stop(), [=] { raw->stop(); }, st::walletBottomButton)
+                      ->setTextTransform(Ui::RoundButton::TextTransform::NoTransform);
+                  break;
+                case ButtonMode::Close:
+                  box->addButton(
+                         ph::lng_wallet_done(), [=] { box->closeBox(); }, st::walletBottomButton)
+                      ->setTextTransform(Ui::RoundButton::TextTransform::NoTransform);
+                  break;
+              }
+            },
+            box->lifetime());
+
+  raw->start();
+}
+
+}  // namespace Wallet
@@ -0,0 +1,143 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "ui/layers/generic_box.h"
+#include "base/weak_ptr.h"
+
+#include "wallet_common.h"
+
+namespace Wallet {
+
+struct BatchTransferRow {
+  int line = 0;
+  QString address;
+  int128 amount = 0;
+  QString comment;
+  std::optional<InvoiceField> invalid;
+};
+
+// Parses "address,amount[,comment]" lines, ';' is accepted as a separator
+// as well. Empty lines, '#' comments and a header line are skipped.
+[[nodiscard]] std::vector<BatchTransferRow> ParseBatchTransfer(const QByteArray &content, const Ton::Symbol &symbol);
+
+enum class BatchTransferKind {
+  Transfer,
+  MultisigConfirmation,
+};
+
+enum class BatchTransferStatus {
+  Invalid,
+  Checking,
+  Checked,
+  Sending,
+  Sent,
+  Failed,
+};
+
+struct BatchTransferChecked {
+  PreparedInvoice invoice;
+  int64 fee = 0;
+  QString error;
+};
+
+struct BatchTransferRowState {
+  BatchTransferStatus status = BatchTransferStatus::Checking;
+  PreparedInvoice invoice;
+  int64 fee = 0;
+  QString error;
+  bool skipped = false;
+};
+
+// Unlocked balances the rows are sent from, fees are paid in TON.
+struct BatchTransferFunds {
+  int128 asset = 0;
+  int128 ton = 0;
+};
+
+struct BatchTransferProgress {
+  int total = 0;
+  int checking = 0;
+  int ready = 0;
+  int waiting = 0;
+  int sent = 0;
+  int failed = 0;
+  int128 amount = 0;
+  int64 fees = 0;
+  int128 readyAmount = 0;
+  int64 readyFees = 0;
+  BatchTransferFunds shortfall;
+  bool sending = false;
+};
+
+// Checks all valid rows with a bounded number of requests in flight and
+// sends the checked ones in order, while the checks keep running ahead.
+// The next row is sent when the previous one is accepted or done: the
+// main wallet accepts one outgoing transaction at a time, while multisig
+// confirmations can be accepted right after the message is sent.
+//
+// When funds are set, sending pauses while the amounts of the rows that
+// are checked or still checking and the known fees don't fit into them.
+class BatchTransfer final : public base::has_weak_ptr {
+ public:
+  using Check = Fn<void(int index, Fn<void(BatchTransferChecked)> done)>;
+  using Send = Fn<void(const PreparedInvoice &invoice, Fn<void()> accepted,
+                       Fn<void(std::optional<QString> error)> done)>;
+
+  BatchTransfer(std::vector<BatchTransferRow> rows, const Ton::Symbol &symbol, Check check);
+
+  void start();
+  void setFunds(const BatchTransferFunds &funds);
+  void send(Send send);
+  bool resume();
+  void stop();
+  void setSkipped(int index, bool skipped);
+  // Returns the row being sent to the checked state, its result is ignored.
+  void interrupt();
+
+  [[nodiscard]] const std::vector<BatchTransferRow> &rows() const;
+  [[nodiscard]] const BatchTransferRowState &state(int index) const;
+  [[nodiscard]] BatchTransferProgress progress() const;
+
+  [[nodiscard]] rpl::producer<int> rowUpdates() const;
+  [[nodiscard]] rpl::producer<BatchTransferProgress> progressValue() const;
+
+  [[nodiscard]] rpl::lifetime &lifetime();
+
+ private:
+  void checkNext();
+  void checked(int index, BatchTransferChecked &&result);
+  void sendNext();
+  void accepted(int index);
+  void sent(int index, std::optional<QString> &&error);
+  void updated(int index);
+
+  const std::vector<BatchTransferRow> _rows;
+  const bool _feesFromAmount = false;
+  const Check _check;
+  Send _send;
+  std::vector<BatchTransferRowState> _states;
+  std::vector<int> _attempts;
+  std::optional<BatchTransferFunds> _funds;
+  int _nextCheck = 0;
+  int _checking = 0;
+  int _nextSend = 0;
+  int _inFlight = -1;
+  bool _sending = false;
+
+  rpl::event_stream<int> _rowUpdates;
+  rpl::event_stream<BatchTransferProgress> _progressChanges;
+  rpl::lifetime _lifetime;
+};
+
+// Sending is allowed only while the rows fit into the funds, see
+// BatchTransfer, confirmations pass no funds and are not limited.
+void BatchTransferBox(not_null<Ui::GenericBox *> box, BatchTransferKind kind, const Ton::Symbol &symbol,
+                      const std::shared_ptr<BatchTransfer> &transfer, rpl::producer<BatchTransferFunds> funds,
+                      const Fn<void()> &askPassword);
+
+}  // namespace Wallet
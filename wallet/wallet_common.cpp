@@ -15,6 +15,7 @@
 #include "styles/style_wallet.h"
 
 #include <QtCore/QLocale>
+#include <QtGui/QTextDocument>
 
 constexpr auto kMaxAmountInt = 9;
 
@@ -149,6 +150,49 @@ QString FillZeros(int128 num, int width, QChar sym) {
   return result;
 }
 
+[[nodiscard]] int Utf8CharLength(const QChar *data, int index, int size) {
+  const auto code = data[index].unicode();
+  if (code < 0x80) {
+    return 1;
+  } else if (code < 0x800) {
+    return 2;
+  } else if (QChar::isHighSurrogate(code) && index + 1 < size && QChar::isLowSurrogate(data[index + 1].unicode())) {
+    return 4;
+  }
+  return 3;
+}
+
+// Longest prefix of [from, till) which fits into budget bytes, never splits a surrogate pair
+[[nodiscard]] int Utf8FittingPrefixEnd(const QString &text, int from, int till, int budget) {
+  const auto data = text.constData();
+  auto i = from;
+  while (i < till) {
+    const auto length = Utf8CharLength(data, i, till);
+    if (length > budget) {
+      break;
+    }
+    budget -= length;
+    i += (length == 4) ? 2 : 1;
+  }
+  return i;
+}
+
+// Shortest suffix start of [from, till) which fits into budget bytes, never splits a surrogate pair
+[[nodiscard]] int Utf8FittingSuffixStart(const QString &text, int from, int till, int budget) {
+  const auto data = text.constData();
+  auto i = till;
+  while (i > from) {
+    const auto pair = (i - 1 > from) && data[i - 1].isLowSurrogate() && data[i - 2].isHighSurrogate();
+    const auto length = pair ? 4 : Utf8CharLength(data, i - 1, till);
+    if (length > budget) {
+      break;
+    }
+    budget -= length;
+    i -= pair ? 2 : 1;
+  }
+  return i;
+}
+
 }  // namespace
 
 FormattedAmount FormatAmount(const int128 &amount, const Ton::Symbol &symbol, FormatFlags flags) {
@@ -373,6 +417,34 @@ QString ExtractMessage(const Ton::Transaction &data) {
   return QString();
 }
 
+TransactionSummary SummarizeTransaction(const Ton::Transaction &data) {
+  auto result = TransactionSummary();
+
+  auto outgoing = int64(0);
+  for (const auto &message : data.outgoing) {
+    outgoing += message.value;
+    if (result.counterparty.isEmpty()) {
+      result.counterparty = message.destination;
+    }
+  }
+  result.value = data.incoming.value - outgoing;
+  if (data.outgoing.empty()) {
+    result.counterparty = data.incoming.source.isEmpty() ? data.incoming.destination : data.incoming.source;
+  }
+
+  const auto &message = data.outgoing.empty() ? data.incoming.message : data.outgoing.front().message;
+  if (!message.data.isEmpty() && message.type == Ton::MessageDataType::EncryptedText) {
+    result.encrypted = true;
+  } else {
+    result.message = message.text;
+  }
+
+  result.incoming = !data.incoming.source.isEmpty();
+  result.pending = (data.id.lt == 0);
+  result.service = IsServiceTransaction(data);
+  return result;
+}
+
 QString FormatTransactionId(int64 transactionId) {
   return "0x" + QString::number(static_cast<uint64>(transactionId), 16);
 }
@@ -433,37 +505,88 @@ not_null<Ui::InputField *> CreateAmountInput(not_null<QWidget *> parent, rpl::pr
   return result;
 }
 
+int Utf8Length(const QString &text, int from, int till) {
+  const auto data = text.constData();
+  const auto size = (till < 0) ? text.size() : std::min(till, text.size());
+  auto result = 0;
+  for (auto i = from; i < size;) {
+    const auto length = Utf8CharLength(data, i, size);
+    result += length;
+    i += (length == 4) ? 2 : 1;
+  }
+  return result;
+}
+
 not_null<Ui::InputField *> CreateCommentInput(not_null<QWidget *> parent, rpl::producer<QString> placeholder,
                                               const QString &value) {
   const auto result = Ui::CreateChild<Ui::InputField>(parent.get(), st::walletInput, Ui::InputField::Mode::MultiLine,
                                                       std::move(placeholder), value);
   result->setMaxLength(kMaxCommentLength);
+
+  // The byte length is kept between changes and adjusted by the edited
+  // range only, the whole text is counted again only if the edits can't
+  // be applied to the last known text (several edits or a replaced text).
+  struct Edit {
+    int position = 0;
+    int removed = 0;
+    int added = 0;
+  };
+  struct State {
+    QString text;
+    int length = 0;
+    std::optional<Edit> edit;
+    bool recount = false;
+  };
+  const auto state = std::make_shared<State>(State{
+      .text = value,
+      .length = Utf8Length(value),
+  });
+  Ui::Connect(result->rawTextEdit()->document(), &QTextDocument::contentsChange,
+              [=](int position, int removed, int added) {
+                if (state->edit) {
+                  state->recount = true;
+                } else {
+                  state->edit = Edit{position, removed, added};
+                }
+              });
+  const auto updateLength = [=](const QString &text) {
+    const auto edit = base::take(state->edit);
+    if (!edit) {
+      return state->length;
+    }
+    const auto applies = !state->recount && edit->position >= 0 &&
+                         edit->position + edit->removed <= state->text.size() &&
+                         state->text.size() - edit->removed + edit->added == text.size();
+    if (applies) {
+      state->length += Utf8Length(text, edit->position, edit->position + edit->added) -
+                       Utf8Length(state->text, edit->position, edit->position + edit->removed);
+    } else {
+      state->length = Utf8Length(text);
+    }
+    state->recount = false;
+    state->text = text;
+    return state->length;
+  };
   Ui::Connect(result, &Ui::InputField::changed, [=] {
     Ui::PostponeCall(result, [=] {
       const auto text = result->getLastText();
-      const auto utf = text.toUtf8();
-      if (utf.size() <= kMaxCommentLength) {
+      const auto length = updateLength(text);
+      if (length <= kMaxCommentLength) {
         return;
       }
-      const auto position = result->textCursor().position();
+      const auto position = std::clamp(result->textCursor().position(), 0, int(text.size()));
+      const auto after = Utf8Length(text, position);
       const auto update = [&](const QString &text, int position) {
         result->setText(text);
         result->setCursorPosition(position);
       };
-      const auto after = text.midRef(position).toUtf8();
-      if (after.size() <= kMaxCommentLength) {
-        const auto remove = utf.size() - kMaxCommentLength;
-        const auto inutf = text.midRef(0, position).toUtf8().size();
-        const auto inserted = utf.mid(inutf - remove, remove);
-        auto cut = QString::fromUtf8(inserted).size();
-        auto updated = text.mid(0, position - cut) + text.midRef(position);
-        while (updated.toUtf8().size() > kMaxCommentLength) {
-          ++cut;
-          updated = text.mid(0, position - cut) + text.midRef(position);
-        }
-        update(updated, position - cut);
+      if (after <= kMaxCommentLength) {
+        // Drop the just typed or pasted characters right before the cursor
+        const auto cut = Utf8FittingPrefixEnd(text, 0, position, kMaxCommentLength - after);
+        update(text.mid(0, cut) + text.midRef(position), cut);
       } else {
-        update(after.mid(after.size() - kMaxCommentLength), 0);
+        const auto start = Utf8FittingSuffixStart(text, position, text.size(), kMaxCommentLength);
+        update(text.mid(start), 0);
       }
     });
   });
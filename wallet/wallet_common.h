@@ -63,6 +63,8 @@ using SelectedAsset = std::variant<SelectedToken, SelectedDePool, SelectedMultis
 
 auto operator==(const SelectedAsset &a, const SelectedAsset &b) -> bool;
 
+using TransactionPtr = std::shared_ptr<const Ton::Transaction>;
+
 struct AddNotification {
   Ton::Symbol symbol;
   Ton::Transaction transaction;
@@ -210,6 +212,8 @@ enum class Action {
   ChangePassword,
   ShowSettings,
   ShowKeystore,
+  BatchTransfer,
+  ConfirmMultisig,
   AddAsset,
   Deploy,
   LogOut,
@@ -232,6 +236,35 @@ constexpr bool is_flag_type(FormatFlag) {
 };
 using FormatFlags = base::flags<FormatFlag>;
 
+struct TransactionSummary {
+  int64 value = 0;
+  QString counterparty;
+  QString message;
+  bool encrypted = false;
+  bool incoming = false;
+  bool pending = false;
+  bool service = false;
+};
+
+enum class SyncPhase { None, Started, Progress };
+
+struct SyncProgress {
+  SyncPhase phase = SyncPhase::None;
+  int percent = 0;
+
+  [[nodiscard]] bool syncing() const {
+    return phase != SyncPhase::None;
+  }
+};
+
+inline bool operator==(const SyncProgress &a, const SyncProgress &b) {
+  return a.phase == b.phase && a.percent == b.percent;
+}
+
+inline bool operator!=(const SyncProgress &a, const SyncProgress &b) {
+  return !(a == b);
+}
+
 struct ParsedAddressTon {
   QString address;
   bool packed{};
@@ -252,6 +285,7 @@ using ParsedAddress = std::variant<ParsedAddressTon, ParsedAddressEth>;
 [[nodiscard]] bool IsEncryptedMessage(const Ton::Transaction &data);
 [[nodiscard]] bool IsServiceTransaction(const Ton::Transaction &data);
 [[nodiscard]] QString ExtractMessage(const Ton::Transaction &data);
+[[nodiscard]] TransactionSummary SummarizeTransaction(const Ton::Transaction &data);
 
 [[nodiscard]] QString FormatTransactionId(int64 transactionId);
 
@@ -264,6 +298,7 @@ not_null<Ui::FlatLabel *> AddBoxSubtitle(not_null<Ui::GenericBox *> box, rpl::pr
 [[nodiscard]] not_null<Ui::InputField *> CreateAmountInput(not_null<QWidget *> parent,
                                                            rpl::producer<QString> placeholder, const int128 &amount,
                                                            const Ton::Symbol &symbol);
+[[nodiscard]] int Utf8Length(const QString &text, int from = 0, int till = -1);
 [[nodiscard]] not_null<Ui::InputField *> CreateCommentInput(not_null<QWidget *> parent,
                                                             rpl::producer<QString> placeholder,
                                                             const QString &value = QString());
@@ -275,4 +310,10 @@ not_null<Ui::FlatLabel *> AddBoxSubtitle(not_null<Ui::GenericBox *> box, rpl::pr
 template <typename A, typename T, typename... Ts>
 constexpr auto is_any_of = std::is_same_v<A, T> || (std::is_same_v<A, Ts> || ...);
 
+// Narrows the state to the part a view depends on, passing it further only when it changes.
+template <typename State, typename Selector>
+[[nodiscard]] auto Select(rpl::producer<State> state, Selector &&selector) {
+  return std::move(state) | rpl::map(std::forward<Selector>(selector)) | rpl::distinct_until_changed();
+}
+
 }  // namespace Wallet
@@ -0,0 +1,201 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "wallet/wallet_contract_details.h"
+
+#include "wallet/wallet_log.h"
+#include "wallet/wallet_trace.h"
+#include "ton/ton_wallet.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+
+namespace Wallet {
+namespace {
+
+constexpr auto kVersion = qint32(1);
+constexpr auto kEventDetailsLifetime = 5 * crl::time(1000);
+constexpr auto kMultisigInfoLifetime = 5 * crl::time(1000);
+constexpr auto kSaveDelay = 2 * crl::time(1000);
+
+}  // namespace
+
+ContractDetails::ContractDetails(not_null<Ton::Wallet *> wallet, const QString &path)
+    : _wallet(wallet)
+    , _path(path)
+    , _saveTimer([=] { save(); }) {
+  load();
+}
+
+ContractDetails::~ContractDetails() {
+  if (_saveScheduled) {
+    save();
+  }
+}
+
+template <typename Value, typename Load>
+void ContractDetails::request(Lookup<Value> &lookup, const QString &key, crl::time lifetime, Load &&load,
+                              Fn<void(Ton::Result<Value>)> done) {
+  WALLET_TRACE_SPAN("ContractDetails::request");
+  if (const auto i = lookup.cached.find(key); i != lookup.cached.end()) {
+    if (crl::now() - i->second.received < lifetime) {
+      return done(i->second.value);
+    }
+    lookup.cached.erase(i);
+  }
+  auto &waiters = lookup.waiters[key];
+  waiters.push_back(std::move(done));
+  if (waiters.size() > 1) {
+    return;
+  }
+  load(key, crl::guard(this, [=, &lookup](Ton::Result<Value> result) {
+    if (result && lifetime > 0) {
+      lookup.cached.emplace(key, typename Lookup<Value>::Entry{*result, crl::now()});
+    }
+    for (const auto &done : lookup.waiters.take(key).value_or(std::vector<Fn<void(Ton::Result<Value>)>>())) {
+      done(result);
+    }
+  }));
+}
+
+void ContractDetails::rootTokenSymbol(const QString &rootContract, Fn<void(Ton::Result<Ton::Symbol>)> done) {
+  if (const auto i = _symbols.find(rootContract); i != _symbols.end()) {
+    return done(i->second);
+  }
+  const auto load = [=](const QString &key, Fn<void(Ton::Result<Ton::Symbol>)> loaded) {
+    _wallet->getRootTokenContractDetails(key, [=](Ton::Result<Ton::RootTokenContractDetails> result) {
+      if (!result) {
+        return loaded(result.error());
+      }
+      loaded(Ton::Symbol::tip3(result->symbol, result->decimals, key));
+    });
+  };
+  request(_symbolLookups, rootContract, 0, load, [=](Ton::Result<Ton::Symbol> result) {
+    if (result && _symbols.emplace(rootContract, *result).second) {
+      saveDelayed();
+    }
+    done(std::move(result));
+  });
+}
+
+void ContractDetails::eventRootTokenContract(const QString &event, EventKind kind,
+                                             Fn<void(Ton::Result<QString>)> done) {
+  if (const auto i = _eventRoots.find(event); i != _eventRoots.end()) {
+    return done(i->second);
+  }
+  const auto loaded = [=](const auto &result) {
+    if (!result) {
+      return done(result.error());
+    }
+    const auto &rootTokenContract = result->rootTokenContract;
+    if (!rootTokenContract.isEmpty() && _eventRoots.emplace(event, rootTokenContract).second) {
+      saveDelayed();
+    }
+    done(rootTokenContract);
+  };
+  switch (kind) {
+    case EventKind::Eth:
+      return ethEventDetails(event, loaded);
+    case EventKind::Ton:
+      return tonEventDetails(event, loaded);
+  }
+  Unexpected("Kind in ContractDetails::eventRootTokenContract.");
+}
+
+void ContractDetails::ethEventDetails(const QString &event, Fn<void(Ton::Result<Ton::EthEventDetails>)> done) {
+  const auto load = [=](const QString &key, Fn<void(Ton::Result<Ton::EthEventDetails>)> loaded) {
+    _wallet->getEthEventDetails(key, std::move(loaded));
+  };
+  request(_ethEventLookups, event, kEventDetailsLifetime, load, std::move(done));
+}
+
+void ContractDetails::tonEventDetails(const QString &event, Fn<void(Ton::Result<Ton::TonEventDetails>)> done) {
+  const auto load = [=](const QString &key, Fn<void(Ton::Result<Ton::TonEventDetails>)> loaded) {
+    _wallet->getTonEventDetails(key, std::move(loaded));
+  };
+  request(_tonEventLookups, event, kEventDetailsLifetime, load, std::move(done));
+}
+
+void ContractDetails::multisigInfo(const QString &address, Fn<void(Ton::Result<Ton::MultisigInfo>)> done) {
+  const auto load = [=](const QString &key, Fn<void(Ton::Result<Ton::MultisigInfo>)> loaded) {
+    _wallet->requestMultisigInfo(key, std::move(loaded));
+  };
+  request(_multisigLookups, address, kMultisigInfoLifetime, load, std::move(done));
+}
+
+void ContractDetails::load() {
+  if (_path.isEmpty()) {
+    return;
+  }
+  auto file = QFile(_path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+  auto stream = QDataStream(&file);
+  stream.setVersion(QDataStream::Qt_5_12);
+
+  auto version = qint32();
+  stream >> version;
+  if (version != kVersion) {
+    return;
+  }
+  auto symbols = quint32();
+  stream >> symbols;
+  for (auto i = quint32(); i != symbols && stream.status() == QDataStream::Ok; ++i) {
+    auto rootContract = QString();
+    auto name = QString();
+    auto decimals = qint32();
+    stream >> rootContract >> name >> decimals;
+    _symbols.emplace(rootContract, Ton::Symbol::tip3(name, decimals, rootContract));
+  }
+  auto eventRoots = quint32();
+  stream >> eventRoots;
+  for (auto i = quint32(); i != eventRoots && stream.status() == QDataStream::Ok; ++i) {
+    auto event = QString();
+    auto rootContract = QString();
+    stream >> event >> rootContract;
+    _eventRoots.emplace(event, rootContract);
+  }
+  if (stream.status() != QDataStream::Ok) {
+    WALLET_LOG(("Contract details: could not read '%1'.").arg(_path));
+    _symbols.clear();
+    _eventRoots.clear();
+  }
+}
+
+void ContractDetails::save() {
+  WALLET_TRACE_SPAN("ContractDetails::save");
+  _saveScheduled = false;
+  QDir().mkpath(QFileInfo(_path).absolutePath());
+  auto file = QSaveFile(_path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    WALLET_LOG(("Contract details: could not write to '%1'.").arg(_path));
+    return;
+  }
+  auto stream = QDataStream(&file);
+  stream.setVersion(QDataStream::Qt_5_12);
+
+  stream << kVersion << quint32(_symbols.size());
+  for (const auto &[rootContract, symbol] : _symbols) {
+    stream << rootContract << symbol.name() << qint32(symbol.decimals());
+  }
+  stream << quint32(_eventRoots.size());
+  for (const auto &[event, rootContract] : _eventRoots) {
+    stream << event << rootContract;
+  }
+  file.commit();
+}
+
+void ContractDetails::saveDelayed() {
+  if (!_path.isEmpty() && !std::exchange(_saveScheduled, true)) {
+    _saveTimer.callOnce(kSaveDelay);
+  }
+}
+
+}  // namespace Wallet
@@ -0,0 +1,76 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "wallet_common.h"
+
+#include "base/timer.h"
+#include "base/weak_ptr.h"
+
+namespace Ton {
+class Wallet;
+}  // namespace Ton
+
+namespace Wallet {
+
+enum class EventKind {
+  Eth,
+  Ton,
+};
+
+// Looks up contract details for the history and the boxes. Concurrent
+// requests for the same contract share one network request.
+//
+// Root token contract symbols and the root contract of an event never
+// change, so they are kept for good and saved to `path` to survive a
+// restart, if it is not empty. Event details and multisig info change with time and are
+// only reused for a few seconds.
+class ContractDetails final : public base::has_weak_ptr {
+ public:
+  ContractDetails(not_null<Ton::Wallet *> wallet, const QString &path);
+  ~ContractDetails();
+
+  void rootTokenSymbol(const QString &rootContract, Fn<void(Ton::Result<Ton::Symbol>)> done);
+  void eventRootTokenContract(const QString &event, EventKind kind, Fn<void(Ton::Result<QString>)> done);
+  void ethEventDetails(const QString &event, Fn<void(Ton::Result<Ton::EthEventDetails>)> done);
+  void tonEventDetails(const QString &event, Fn<void(Ton::Result<Ton::TonEventDetails>)> done);
+  void multisigInfo(const QString &address, Fn<void(Ton::Result<Ton::MultisigInfo>)> done);
+
+ private:
+  template <typename Value>
+  struct Lookup {
+    struct Entry {
+      Value value;
+      crl::time received = 0;
+    };
+    base::flat_map<QString, Entry> cached;
+    base::flat_map<QString, std::vector<Fn<void(Ton::Result<Value>)>>> waiters;
+  };
+
+  template <typename Value, typename Load>
+  void request(Lookup<Value> &lookup, const QString &key, crl::time lifetime, Load &&load,
+               Fn<void(Ton::Result<Value>)> done);
+
+  void load();
+  void save();
+  void saveDelayed();
+
+  const not_null<Ton::Wallet *> _wallet;
+  const QString _path;
+
+  base::flat_map<QString, Ton::Symbol> _symbols;
+  base::flat_map<QString, QString> _eventRoots;
+  bool _saveScheduled = false;
+  base::Timer _saveTimer;
+
+  Lookup<Ton::Symbol> _symbolLookups;
+  Lookup<Ton::EthEventDetails> _ethEventLookups;
+  Lookup<Ton::TonEventDetails> _tonEventLookups;
+  Lookup<Ton::MultisigInfo> _multisigLookups;
+};
+
+}  // namespace Wallet
@@ -426,7 +426,18 @@ rpl::producer<CoverState> MakeCoverState(rpl::producer<Ton::WalletViewerState> s
                });
 
            return result;
-         });
+         }) |
+         rpl::distinct_until_changed();
+}
+
+bool operator==(const CoverState &a, const CoverState &b) {
+  return a.asset == b.asset && a.unlockedBalance == b.unlockedBalance && a.lockedBalance == b.lockedBalance &&
+         a.reward == b.reward && a.justCreated == b.justCreated && a.useTestNetwork == b.useTestNetwork &&
+         a.reinvest == b.reinvest && a.isDeployed == b.isDeployed && a.shouldUpgrade == b.shouldUpgrade;
+}
+
+bool operator!=(const CoverState &a, const CoverState &b) {
+  return !(a == b);
 }
 
 }  // namespace Wallet
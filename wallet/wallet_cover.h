@@ -31,6 +31,9 @@ struct CoverState {
   [[nodiscard]] auto selectedToken() const -> Ton::Symbol;
 };
 
+bool operator==(const CoverState &a, const CoverState &b);
+bool operator!=(const CoverState &a, const CoverState &b);
+
 class Cover final {
  public:
   Cover(not_null<Ui::RpWidget *> parent, rpl::producer<CoverState> state);
@@ -65,7 +65,7 @@ void CreateInvoiceBox(not_null<Ui::GenericBox *> box, const QString &address, bo
     if (parsed.value_or(0) <= 0) {
       amount->showError();
       return std::nullopt;
-    } else if (text.toUtf8().size() > kMaxCommentLength) {
+    } else if (Utf8Length(text) > kMaxCommentLength) {
       comment->showError();
       return std::nullopt;
     }
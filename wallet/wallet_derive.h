@@ -0,0 +1,77 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include <crl/crl_async.h>
+
+namespace Wallet {
+namespace details {
+
+template <typename Value, typename Result, typename Method>
+class AsyncDeriver final : public std::enable_shared_from_this<AsyncDeriver<Value, Result, Method>> {
+ public:
+  AsyncDeriver(Method method, Fn<void(Result &&)> done)
+      : _method(std::make_shared<Method>(std::move(method)))
+      , _done(std::move(done)) {
+  }
+
+  void push(Value &&value) {
+    _pending = std::move(value);
+    if (!_working) {
+      start();
+    }
+  }
+
+ private:
+  // The worker never owns the deriver, so it is always destroyed on the main thread together with the
+  // consumer. The method is passed back to the main thread as well, so the last reference is dropped there.
+  void start() {
+    _working = true;
+    crl::async([weak = this->weak_from_this(), method = _method, value = *base::take(_pending)]() mutable {
+      // Only one value is processed at a time, so the method needs no locking.
+      auto result = (*method)(std::move(value));
+      crl::on_main([weak, method = std::move(method), result = std::move(result)]() mutable {
+        if (const auto strong = weak.lock()) {
+          strong->finish(std::move(result));
+        }
+      });
+    });
+  }
+
+  void finish(Result &&result) {
+    _working = false;
+    _done(std::move(result));
+    if (_pending) {
+      start();
+    }
+  }
+
+  const std::shared_ptr<Method> _method;
+  const Fn<void(Result &&)> _done;
+  std::optional<Value> _pending;
+  bool _working = false;
+};
+
+}  // namespace details
+
+// Applies the method to every value on a background thread and delivers the results on the main thread in order.
+// While a value is processed only the latest of the newly arrived ones is kept. Every subscription gets its own
+// copy of the method, so it may keep state between the values, for example to produce diffs.
+template <typename Result, typename Value, typename Error, typename Generator, typename Method>
+[[nodiscard]] rpl::producer<Result> DeriveAsync(rpl::producer<Value, Error, Generator> &&values, Method method) {
+  return rpl::make_producer<Result>([values = std::move(values), method = std::move(method)](const auto &consumer) {
+    using Deriver = details::AsyncDeriver<Value, Result, Method>;
+
+    auto result = rpl::lifetime();
+    const auto deriver = std::make_shared<Deriver>(method, [=](Result &&value) { consumer.put_next(std::move(value)); });
+    result.add([deriver] {});
+    rpl::duplicate(values) | rpl::start_with_next([=](Value &&value) { deriver->push(std::move(value)); }, result);
+    return result;
+  });
+}
+
+}  // namespace Wallet
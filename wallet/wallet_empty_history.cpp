@@ -108,15 +108,16 @@ void EmptyHistory::setupControls(rpl::producer<EmptyHistoryState> &&state) {
 rpl::producer<EmptyHistoryState> MakeEmptyHistoryState(rpl::producer<Ton::WalletViewerState> state,
                                                        rpl::producer<std::optional<SelectedAsset>> selectedAsset,
                                                        bool justCreated) {
-  return rpl::combine(std::move(state), std::move(selectedAsset))  //
+  auto walletAddress = Select(std::move(state), [](const Ton::WalletViewerState &state) { return state.wallet.address; });
+  return rpl::combine(std::move(walletAddress), std::move(selectedAsset))  //
          | rpl::map(
-               [justCreated](const Ton::WalletViewerState &state, const std::optional<SelectedAsset> &selectedAsset) {
+               [justCreated](const QString &walletAddress, const std::optional<SelectedAsset> &selectedAsset) {
                  const auto asset = selectedAsset.value_or(SelectedToken{.symbol = Ton::Symbol::ton()});
 
                  const auto [address, labelType] = v::match(
                      asset,
                      [&](const SelectedToken &selectedToken) {
-                       return std::make_pair(state.wallet.address, selectedToken.symbol.isTon()
+                       return std::make_pair(walletAddress, selectedToken.symbol.isTon()
                                                                        ? AddressLabelType::YourAddress
                                                                        : AddressLabelType::TokenAddress);
                      },
@@ -128,6 +129,16 @@ rpl::producer<EmptyHistoryState> MakeEmptyHistoryState(rpl::producer<Ton::Wallet
                      });
 
                  return EmptyHistoryState{address, labelType, justCreated};
-               });
+               })  //
+         | rpl::distinct_until_changed();
 }
+
+bool operator==(const EmptyHistoryState &a, const EmptyHistoryState &b) {
+  return a.address == b.address && a.addressType == b.addressType && a.justCreated == b.justCreated;
+}
+
+bool operator!=(const EmptyHistoryState &a, const EmptyHistoryState &b) {
+  return !(a == b);
+}
+
 }  // namespace Wallet
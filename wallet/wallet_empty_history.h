@@ -24,6 +24,9 @@ struct EmptyHistoryState {
   bool justCreated = false;
 };
 
+bool operator==(const EmptyHistoryState &a, const EmptyHistoryState &b);
+bool operator!=(const EmptyHistoryState &a, const EmptyHistoryState &b);
+
 class EmptyHistory final {
  public:
   EmptyHistory(not_null<Ui::RpWidget *> parent, rpl::producer<EmptyHistoryState> state,
@@ -0,0 +1,184 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "wallet/wallet_fee_estimator.h"
+
+#include "wallet/wallet_trace.h"
+#include "ton/ton_wallet.h"
+
+namespace Wallet {
+namespace {
+
+constexpr auto kCacheLifetime = 60 * crl::time(1000);
+constexpr auto kMaxCached = 16;
+
+[[nodiscard]] int AmountBucket(int128 amount) {
+  auto result = 0;
+  while (amount > 0) {
+    amount /= 10;
+    ++result;
+  }
+  return result;
+}
+
+}  // namespace
+
+FeeEstimator::FeeEstimator(not_null<Ton::Wallet *> wallet) : _wallet(wallet) {
+}
+
+void FeeEstimator::estimate(const QByteArray &sender, const TonTransferInvoice &invoice) {
+  estimate(ComputeKey(sender, invoice), tonRequest(sender, invoice));
+}
+
+void FeeEstimator::estimate(const QByteArray &sender, const TokenTransferInvoice &invoice) {
+  estimate(ComputeKey(sender, invoice), tokenRequest(sender, invoice));
+}
+
+void FeeEstimator::check(const QByteArray &sender, const TonTransferInvoice &invoice, const int128 &available,
+                         Fn<void(Ton::Result<Ton::TransactionCheckResult>)> done) {
+  const auto key = ComputeKey(sender, invoice);
+  check(key, tonRequest(sender, invoice), invoice.amount, available, [=](Result result) {
+    if (!result) {
+      return done(result.error());
+    }
+    done(std::move(result->first));
+  });
+}
+
+void FeeEstimator::check(const QByteArray &sender, const TokenTransferInvoice &invoice, const int128 &available,
+                         Fn<void(Ton::Result<TokenCheckResult>)> done) {
+  check(ComputeKey(sender, invoice), tokenRequest(sender, invoice), invoice.realAmount, available, std::move(done));
+}
+
+auto FeeEstimator::ComputeKey(const QByteArray &sender, const TonTransferInvoice &invoice) -> Key {
+  return Key{
+      .sender = sender,
+      .recipient = invoice.address,
+      .amountBucket = AmountBucket(invoice.amount),
+      .commentSize = Utf8Length(invoice.comment),
+  };
+}
+
+auto FeeEstimator::ComputeKey(const QByteArray &sender, const TokenTransferInvoice &invoice) -> Key {
+  return Key{
+      .sender = sender,
+      .token = invoice.rootContractAddress,
+      .recipient = invoice.address,
+      .callback = invoice.callbackAddress,
+      .transferType = static_cast<int>(invoice.transferType),
+      .amountBucket = AmountBucket(invoice.amount),
+  };
+}
+
+auto FeeEstimator::tonRequest(const QByteArray &sender, const TonTransferInvoice &invoice) const -> Request {
+  return [=, wallet = _wallet](Fn<void(Result)> done) {
+    wallet->checkSendGrams(sender, invoice.asTransaction(), [=](Ton::Result<Ton::TransactionCheckResult> result) {
+      if (!result) {
+        return done(result.error());
+      }
+      done(TokenCheckResult{std::move(*result), Ton::TokenTransferUnchanged{}});
+    });
+  };
+}
+
+auto FeeEstimator::tokenRequest(const QByteArray &sender, const TokenTransferInvoice &invoice) const -> Request {
+  return [=, wallet = _wallet](Fn<void(Result)> done) {
+    wallet->checkSendTokens(sender, invoice.asTransaction(), std::move(done));
+  };
+}
+
+void FeeEstimator::estimate(const Key &key, Request request) {
+  if (lookup(key) || _inFlight == key) {
+    return;
+  } else if (_inFlight) {
+    _queued = Queued{key, std::move(request)};
+    return;
+  }
+  _queued = std::nullopt;
+  start(key, request);
+}
+
+void FeeEstimator::check(const Key &key, Request request, int128 required, int128 available, Fn<void(Result)> done) {
+  WALLET_TRACE_SPAN("FeeEstimator::check");
+  _queued = std::nullopt;
+
+  // The estimate was made for an amount with the same number of digits,
+  // so errors about the exact amount are left for the network check.
+  const auto fits = [=](const TokenCheckResult &result) {
+    return required + result.first.sourceFees.sum() <= available;
+  };
+  const auto send = [=] {
+    request(crl::guard(this, [=](Result result) {
+      store(key, result);
+      done(std::move(result));
+    }));
+  };
+  if (const auto entry = lookup(key)) {
+    if (fits(entry->result)) {
+      done(entry->result);
+    } else {
+      send();
+    }
+  } else if (_inFlight == key) {
+    _waiters.push_back([=](const Result &result) {
+      if (result && fits(*result)) {
+        done(result);
+      } else {
+        send();
+      }
+    });
+  } else {
+    send();
+  }
+}
+
+void FeeEstimator::start(const Key &key, const Request &request) {
+  WALLET_TRACE_SPAN("FeeEstimator::start");
+  _inFlight = key;
+  request(crl::guard(this, [=](Result result) { finished(key, std::move(result)); }));
+}
+
+void FeeEstimator::finished(const Key &key, Result &&result) {
+  store(key, result);
+  _inFlight = std::nullopt;
+  for (const auto &done : base::take(_waiters)) {
+    done(result);
+  }
+  if (auto queued = base::take(_queued)) {
+    estimate(queued->key, std::move(queued->request));
+  }
+}
+
+void FeeEstimator::store(const Key &key, const Result &result) {
+  if (!result) {
+    return;
+  }
+  const auto now = crl::now();
+  for (auto i = _cache.begin(); i != _cache.end();) {
+    if (now - i->second.received >= kCacheLifetime) {
+      i = _cache.erase(i);
+    } else {
+      ++i;
+    }
+  }
+  _cache[key] = Entry{*result, now};
+  if (_cache.size() > kMaxCached) {
+    _cache.erase(ranges::min_element(_cache, ranges::less(), [](const auto &pair) { return pair.second.received; }));
+  }
+}
+
+auto FeeEstimator::lookup(const Key &key) -> const Entry * {
+  const auto i = _cache.find(key);
+  if (i == _cache.end()) {
+    return nullptr;
+  } else if (crl::now() - i->second.received >= kCacheLifetime) {
+    _cache.erase(i);
+    return nullptr;
+  }
+  return &i->second;
+}
+
+}  // namespace Wallet
@@ -0,0 +1,91 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "wallet_common.h"
+
+#include "base/weak_ptr.h"
+
+namespace Ton {
+class Wallet;
+}  // namespace Ton
+
+namespace Wallet {
+
+// Checks transfers in the background while they are being composed, so that
+// the confirmation usually opens with the fees already known.
+//
+// Successful checks are cached for a short time by sender, token, recipient,
+// amount bucket and comment size: fees depend on the message size rather than
+// on the exact amount. Only one estimate is in flight at a time, a newer one
+// replaces the queued estimate, so stale ones are never requested.
+class FeeEstimator final : public base::has_weak_ptr {
+ public:
+  using TokenCheckResult = std::pair<Ton::TransactionCheckResult, Ton::TokenTransferCheckResult>;
+
+  explicit FeeEstimator(not_null<Ton::Wallet *> wallet);
+
+  void estimate(const QByteArray &sender, const TonTransferInvoice &invoice);
+  void estimate(const QByteArray &sender, const TokenTransferInvoice &invoice);
+
+  // Reuses a cached or an in flight estimate of the same transfer only if
+  // the exact amount and the estimated fees fit into the unlocked TON
+  // balance, otherwise the transfer is checked by the network.
+  void check(const QByteArray &sender, const TonTransferInvoice &invoice, const int128 &available,
+             Fn<void(Ton::Result<Ton::TransactionCheckResult>)> done);
+  void check(const QByteArray &sender, const TokenTransferInvoice &invoice, const int128 &available,
+             Fn<void(Ton::Result<TokenCheckResult>)> done);
+
+ private:
+  struct Key {
+    QByteArray sender;
+    QString token;
+    QString recipient;
+    QString callback;
+    int transferType = 0;
+    int amountBucket = 0;
+    int commentSize = 0;
+
+    friend inline bool operator<(const Key &a, const Key &b) {
+      return std::tie(a.sender, a.token, a.recipient, a.callback, a.transferType, a.amountBucket, a.commentSize) <
+             std::tie(b.sender, b.token, b.recipient, b.callback, b.transferType, b.amountBucket, b.commentSize);
+    }
+    friend inline bool operator==(const Key &a, const Key &b) {
+      return !(a < b) && !(b < a);
+    }
+  };
+  struct Entry {
+    TokenCheckResult result;
+    crl::time received = 0;
+  };
+  using Result = Ton::Result<TokenCheckResult>;
+  using Request = Fn<void(Fn<void(Result)> done)>;
+  struct Queued {
+    Key key;
+    Request request;
+  };
+
+  [[nodiscard]] static Key ComputeKey(const QByteArray &sender, const TonTransferInvoice &invoice);
+  [[nodiscard]] static Key ComputeKey(const QByteArray &sender, const TokenTransferInvoice &invoice);
+  [[nodiscard]] Request tonRequest(const QByteArray &sender, const TonTransferInvoice &invoice) const;
+  [[nodiscard]] Request tokenRequest(const QByteArray &sender, const TokenTransferInvoice &invoice) const;
+
+  void estimate(const Key &key, Request request);
+  void check(const Key &key, Request request, int128 required, int128 available, Fn<void(Result)> done);
+  void start(const Key &key, const Request &request);
+  void finished(const Key &key, Result &&result);
+  void store(const Key &key, const Result &result);
+  [[nodiscard]] const Entry *lookup(const Key &key);
+
+  const not_null<Ton::Wallet *> _wallet;
+  base::flat_map<Key, Entry> _cache;
+  std::optional<Key> _inFlight;
+  std::vector<Fn<void(const Result &)>> _waiters;
+  std::optional<Queued> _queued;
+};
+
+}  // namespace Wallet
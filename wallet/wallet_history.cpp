@@ -8,6 +8,8 @@
 
 #include "wallet/wallet_common.h"
 #include "wallet/wallet_phrases.h"
+#include "wallet/wallet_trace.h"
+#include "wallet/wallet_derive.h"
 #include "base/unixtime.h"
 #include "base/flags.h"
 #include "base/object_ptr.h"
@@ -125,16 +127,17 @@ void refreshTimeTexts(TransactionLayout &layout, bool forceDateText = false) {
   }
 }
 
-[[nodiscard]] TransactionLayout prepareRegularLayout(const Ton::Transaction &data, const Fn<void()> &decrypt,
+[[nodiscard]] TransactionLayout prepareRegularLayout(const Ton::Transaction &data, const TransactionSummary &summary,
+                                                     const Fn<void()> &decrypt,
                                                      const RegularTransactionParams &params) {
-  const auto service = IsServiceTransaction(data);
-  const auto encrypted = IsEncryptedMessage(data) && decrypt;
-  const auto amount = FormatAmount(service ? (-data.fee) : CalculateValue(data), Ton::Symbol::ton(),
+  const auto service = summary.service;
+  const auto encrypted = summary.encrypted && decrypt;
+  const auto amount = FormatAmount(service ? (-data.fee) : summary.value, Ton::Symbol::ton(),
                                    FormatFlag::Signed | FormatFlag::Rounded);
-  const auto incoming = !data.incoming.source.isEmpty();
-  const auto pending = (data.id.lt == 0);
+  const auto incoming = summary.incoming;
+  const auto pending = summary.pending;
 
-  const auto extractedAddress = ExtractAddress(data);
+  const auto &extractedAddress = summary.counterparty;
   const auto address = extractedAddress.isEmpty() ? QString{} : Ton::Wallet::ConvertIntoRaw(extractedAddress);
   const auto addressPartWidth = [&](int from, int length = -1) {
     return addressStyle().font->width(address.mid(from, length));
@@ -154,7 +157,7 @@ void refreshTimeTexts(TransactionLayout &layout, bool forceDateText = false) {
                         std::max(addressPartWidth(0, address.size() / 2), addressPartWidth(address.size() / 2));
   result.addressHeight = addressStyle().font->height * 2;
   result.comment = Ui::Text::String(st::walletAddressWidthMin);
-  result.comment.setText(st::defaultTextStyle, (encrypted ? QString() : ExtractMessage(data)), _textPlainOptions);
+  result.comment.setText(st::defaultTextStyle, summary.message, _textPlainOptions);
 
   const auto fee = FormatAmount(data.fee, Ton::Symbol::ton()).full;
   result.fees.setText(st::defaultTextStyle, ph::lng_wallet_row_fees(ph::now).replace("{amount}", fee));
@@ -191,13 +194,13 @@ void refreshTimeTexts(TransactionLayout &layout, bool forceDateText = false) {
   return result;
 }
 
-[[nodiscard]] TransactionLayout prepareMultisigLayout(const Ton::Transaction &data,
+[[nodiscard]] TransactionLayout prepareMultisigLayout(const Ton::Transaction &data, const TransactionSummary &summary,
                                                       const MultisigTransactionParams &params) {
-  const auto amount = FormatAmount(CalculateValue(data), Ton::Symbol::ton(), FormatFlag::Signed | FormatFlag::Rounded);
-  const auto incoming = !data.incoming.source.isEmpty();
-  const auto pending = (data.id.lt == 0);
+  const auto amount = FormatAmount(summary.value, Ton::Symbol::ton(), FormatFlag::Signed | FormatFlag::Rounded);
+  const auto incoming = summary.incoming;
+  const auto pending = summary.pending;
 
-  const auto extractedAddress = ExtractAddress(data);
+  const auto &extractedAddress = summary.counterparty;
   const auto address = extractedAddress.isEmpty() ? QString{} : Ton::Wallet::ConvertIntoRaw(extractedAddress);
   const auto partWidth = [](const QString &address, int from, int length = -1) {
     return addressStyle().font->width(address.mid(from, length));
@@ -260,14 +263,14 @@ void refreshTimeTexts(TransactionLayout &layout, bool forceDateText = false) {
       },
       [&](const Ton::MultisigConfirmTransaction &confirmTransaction) {
         showAmount = confirmTransaction.executed;
-        comment = ExtractMessage(data);
+        comment = summary.message;
         result.additionalInfo = FormatTransactionId(confirmTransaction.transactionId);
         result.type = TransactionType::MultisigConfirm;
         setAddress();
       },
       [&](auto &&) {
         showAmount = true;
-        comment = ExtractMessage(data);
+        comment = summary.message;
         result.type = TransactionType::Transfer;
         setAddress();
       });
@@ -291,13 +294,14 @@ void refreshTimeTexts(TransactionLayout &layout, bool forceDateText = false) {
   return result;
 }
 
-[[nodiscard]] std::optional<TransactionLayout> prepareDePoolLayout(const Ton::Transaction &data) {
+[[nodiscard]] std::optional<TransactionLayout> prepareDePoolLayout(const Ton::Transaction &data,
+                                                                   const TransactionSummary &summary) {
   using Properties = std::optional<std::tuple<int64, int64, TransactionType>>;
   auto properties = v::match(
       data.additional,
       [&](const Ton::DePoolOrdinaryStakeTransaction &dePoolOrdinaryStakeTransaction) -> Properties {
         return std::make_tuple(-dePoolOrdinaryStakeTransaction.stake,
-                               -CalculateValue(data) - dePoolOrdinaryStakeTransaction.stake + data.otherFee,
+                               -summary.value - dePoolOrdinaryStakeTransaction.stake + data.otherFee,
                                TransactionType::DePoolStake);
       },
       [&](const Ton::DePoolOnRoundCompleteTransaction &dePoolOnRoundCompleteTransaction) -> Properties {
@@ -313,9 +317,9 @@ void refreshTimeTexts(TransactionLayout &layout, bool forceDateText = false) {
 
   const auto amount = FormatAmount(value, token, FormatFlag::Signed | FormatFlag::Rounded);
 
-  const auto incoming = !data.incoming.source.isEmpty();
-  const auto pending = (data.id.lt == 0);
-  const auto address = Ton::Wallet::ConvertIntoRaw(ExtractAddress(data));
+  const auto incoming = summary.incoming;
+  const auto pending = summary.pending;
+  const auto address = Ton::Wallet::ConvertIntoRaw(summary.counterparty);
   const auto addressPartWidth = [&](int from, int length = -1) {
     return addressStyle().font->width(address.mid(from, length));
   };
@@ -344,7 +348,8 @@ void refreshTimeTexts(TransactionLayout &layout, bool forceDateText = false) {
 }
 
 [[nodiscard]] std::optional<TransactionLayout> prepareTokenLayout(const Ton::Symbol &token,
-                                                                  const Ton::Transaction &transaction) {
+                                                                  const Ton::Transaction &transaction,
+                                                                  const TransactionSummary &summary) {
   using Properties = std::optional<std::tuple<QString, int128, bool, TransactionType>>;
   auto properties = v::match(
       transaction.additional,
@@ -395,7 +400,7 @@ void refreshTimeTexts(TransactionLayout &layout, bool forceDateText = false) {
   result.comment = Ui::Text::String(st::walletAddressWidthMin);
   result.comment.setText(st::defaultTextStyle, {}, _textPlainOptions);
 
-  const auto fee = FormatAmount(CalculateValue(transaction), Ton::Symbol::ton()).full;
+  const auto fee = FormatAmount(summary.value, Ton::Symbol::ton()).full;
   result.fees.setText(st::defaultTextStyle, ph::lng_wallet_row_fees(ph::now).replace("{amount}", fee));
 
   result.flags = incoming ? Flag::Incoming : Flag(0);
@@ -409,9 +414,10 @@ void refreshTimeTexts(TransactionLayout &layout, bool forceDateText = false) {
 
 class HistoryRow final {
  public:
-  explicit HistoryRow(Ton::Transaction transaction, const Fn<void()> &decrypt = nullptr)
+  explicit HistoryRow(TransactionPtr transaction, const Fn<void()> &decrypt = nullptr)
       : _symbol(Ton::Symbol::ton())
-      , _layout(prepareRegularLayout(transaction, _decrypt, RegularTransactionParams{}))
+      , _summary(SummarizeTransaction(*transaction))
+      , _layout(prepareRegularLayout(*transaction, _summary, decrypt, RegularTransactionParams{}))
       , _transaction(std::move(transaction))
       , _decrypt(decrypt) {
   }
@@ -420,7 +426,7 @@ class HistoryRow final {
   HistoryRow &operator=(const HistoryRow &) = delete;
 
   [[nodiscard]] const Ton::TransactionId &id() const {
-    return _transaction.id;
+    return _transaction->id;
   }
 
   [[nodiscard]] const QDateTime &date() const {
@@ -428,10 +434,19 @@ class HistoryRow final {
   }
 
   [[nodiscard]] const Ton::Transaction &transaction() const {
-    return _transaction;
+    return *_transaction;
   }
-  [[nodiscard]] Ton::Transaction &transaction() {
-    return _transaction;
+
+  void setTokenTransferOwner(const QString &owner) {
+    auto copy = *_transaction;
+    auto &transfer = v::get<Ton::TokenTransfer>(copy.additional);
+    transfer.address = owner;
+    transfer.direct = false;
+    _transaction = std::make_shared<const Ton::Transaction>(std::move(copy));
+  }
+
+  [[nodiscard]] const TransactionSummary &summary() const {
+    return _summary;
   }
 
   void refreshDate() {
@@ -521,23 +536,23 @@ class HistoryRow final {
   void setRegularLayout(const RegularTransactionParams &params) {
     resetButton();
     _symbol = Ton::Symbol::ton();
-    _layout = prepareRegularLayout(_transaction, _decrypt, params);
+    _layout = prepareRegularLayout(*_transaction, _summary, _decrypt, params);
     setVisible(true);
   }
   void setTokenTransactionLayout(const Ton::Symbol &symbol) {
     resetButton();
-    auto layout = prepareTokenLayout(symbol, _transaction);
+    auto layout = prepareTokenLayout(symbol, *_transaction, _summary);
     if (layout.has_value()) {
       _layout = std::move(*layout);
       _symbol = symbol;
-      setVisible(!_transaction.aborted || _transaction.incoming.bounce);
+      setVisible(!_transaction->aborted || _transaction->incoming.bounce);
     } else {
       setVisible(false);
     }
   }
   void setDePoolTransactionLayout() {
     resetButton();
-    auto layout = prepareDePoolLayout(_transaction);
+    auto layout = prepareDePoolLayout(*_transaction, _summary);
     if (layout.has_value()) {
       _layout = std::move(*layout);
       _symbol = Ton::Symbol::ton();
@@ -565,7 +580,7 @@ class HistoryRow final {
   void setMultisigLayout(MultisigTransactionParams params = MultisigTransactionParams{}) {
     resetButton();
     _symbol = Ton::Symbol::ton();
-    _layout = prepareMultisigLayout(_transaction, params);
+    _layout = prepareMultisigLayout(*_transaction, _summary, params);
     setVisible(true);
   }
   void setMultisigSubmitTransactionLayout(not_null<Ui::RpWidget *> parent, SubmitTransactionStatus status,
@@ -781,9 +796,10 @@ class HistoryRow final {
   }
 
   Ton::Symbol _symbol;
+  TransactionSummary _summary;
   TransactionLayout _layout;
 
-  Ton::Transaction _transaction;
+  TransactionPtr _transaction;
 
   Fn<void()> _decrypt = [] {};
 
@@ -827,10 +843,13 @@ History::History(not_null<Ui::RpWidget *> parent, rpl::producer<HistoryState> st
   std::move(collectEncrypted)  //
       | rpl::start_with_next(
             [=](not_null<std::vector<Ton::Transaction> *> list) {
-              auto it = _transactions.find(kMainPageKey);
-              if (it != end(_transactions)) {
-                auto &&encrypted = ranges::views::all(it->second.list) | ranges::views::filter(IsEncryptedMessage);
-                list->insert(list->end(), encrypted.begin(), encrypted.end());
+              auto it = _rows.find(kMainPageKey);
+              if (it != end(_rows)) {
+                for (const auto &row : it->second.regular) {
+                  if (row->summary().encrypted) {
+                    list->push_back(row->transaction());
+                  }
+                }
               }
             },
             _widget.lifetime());
@@ -838,15 +857,15 @@ History::History(not_null<Ui::RpWidget *> parent, rpl::producer<HistoryState> st
   std::move(updateDecrypted)  //
       | rpl::start_with_next(
             [=](not_null<const std::vector<Ton::Transaction> *> list) {
-              auto it = _transactions.find(kMainPageKey);
-              if (it == end(_transactions)) {
+              auto it = _rows.find(kMainPageKey);
+              if (it == end(_rows) || _transactions.find(kMainPageKey) == end(_transactions)) {
                 return;
               }
-              auto &transactions = it->second;
+              const auto &rows = it->second.regular;
 
               auto changed = false;
-              for (auto i = 0, count = static_cast<int>(transactions.list.size()); i != count; ++i) {
-                if (IsEncryptedMessage(transactions.list[i])) {
+              for (auto i = 0, count = static_cast<int>(rows.size()); i != count; ++i) {
+                if (rows[i]->summary().encrypted) {
                   if (takeDecrypted(i, *list)) {
                     changed = true;
                   }
@@ -897,6 +916,7 @@ void History::updateGeometry(QPoint position, int width) {
 }
 
 void History::resizeToWidth(int width) {
+  WALLET_TRACE_SPAN("History::resizeToWidth");
   if (!width) {
     return;
   }
@@ -967,11 +987,11 @@ rpl::producer<std::pair<HistoryPageKey, Ton::TransactionId>> History::preloadReq
   return _preloadRequests.events();
 }
 
-rpl::producer<Ton::Transaction> History::viewRequests() const {
+rpl::producer<TransactionPtr> History::viewRequests() const {
   return _viewRequests.events();
 }
 
-rpl::producer<Ton::Transaction> History::decryptRequests() const {
+rpl::producer<TransactionPtr> History::decryptRequests() const {
   return _decryptRequests.events();
 }
 
@@ -1022,8 +1042,10 @@ void History::setupContent(rpl::producer<HistoryState> &&state,
               auto &transactions = it->second;
 
               transactions.previousId = slice.second.data.previousId;
-              transactions.list.insert(end(transactions.list), slice.second.data.list.begin(),
-                                       slice.second.data.list.end());
+              transactions.list.reserve(transactions.list.size() + slice.second.data.list.size());
+              for (const auto &transaction : slice.second.data.list) {
+                transactions.list.push_back(std::make_shared<const Ton::Transaction>(transaction));
+              }
               refreshRows(_selectedAsset.current());
             },
             lifetime());
@@ -1177,7 +1199,8 @@ void History::releaseRow() {
   } else {
     const auto it = _transactions.find(pending ? kMainPageKey : page);
     if (it != _transactions.end()) {
-      const auto i = ranges::find(it->second.list, rows[selected]->id(), &Ton::Transaction::id);
+      const auto id = rows[selected]->id();
+      const auto i = ranges::find_if(it->second.list, [&](const TransactionPtr &item) { return item->id == id; });
       Assert(i != end(it->second.list));
       _viewRequests.fire_copy(*i);
     }
@@ -1191,12 +1214,13 @@ void History::decryptById(const Ton::TransactionId &id) {
   }
   const auto &transactions = transactionsIt->second;
 
-  const auto i = ranges::find(transactions.list, id, &Ton::Transaction::id);
+  const auto i = ranges::find_if(transactions.list, [&](const TransactionPtr &item) { return item->id == id; });
   Assert(i != end(transactions.list));
   _decryptRequests.fire_copy(*i);
 }
 
 void History::paint(Painter &p, QRect clip) {
+  WALLET_TRACE_SPAN("History::paint");
   auto rowsIt = _rows.find(currentPage());
   if (rowsIt == _rows.end()) {
     return;
@@ -1235,8 +1259,13 @@ void History::paint(Painter &p, QRect clip) {
 }
 
 void History::mergeState(HistoryState &&state) {
-  _knownContracts = std::move(state.knownContracts);
-  _multisigTimeouts = std::move(state.multisigTimeouts);
+  WALLET_TRACE_SPAN("History::mergeState");
+  if (state.knownContracts) {
+    _knownContracts = std::move(*state.knownContracts);
+  }
+  if (state.multisigTimeouts) {
+    _multisigTimeouts = std::move(*state.multisigTimeouts);
+  }
   mergePending(std::move(state.pendingTransactions));
   //refreshPending();
   if (mergeListChanged(std::move(state.lastTransactions))) {
@@ -1269,7 +1298,8 @@ void History::mergeNotifications(NotificationsHistoryUpdate &&update) {
         while (latestIt != rows.end() && notification.transaction.id.lt < (*latestIt)->transaction().id.lt) {
           ++latestIt;
         }
-        it->second.pending.insert(latestIt, makeRow(notification.transaction));
+        it->second.pending.insert(latestIt,
+                                  makeRow(std::make_shared<const Ton::Transaction>(notification.transaction)));
 
         const auto asset = SelectedToken{.symbol = notification.symbol};
         if (newSymbol) {
@@ -1307,15 +1337,20 @@ bool History::mergeListChanged(std::map<HistoryPageKey, Ton::TransactionsSlice>
     }
     auto &transactions = transactionsIt->second;
 
+    const auto share = [](const Ton::Transaction &transaction) {
+      return std::make_shared<const Ton::Transaction>(transaction);
+    };
+
     const auto i = transactions.list.empty()  //
                        ? newTransactions.list.cend()
-                       : ranges::find(std::as_const(newTransactions.list), transactions.list.front());
+                       : ranges::find(std::as_const(newTransactions.list), *transactions.list.front());
     if (i == newTransactions.list.cend()) {
-      transactions.list = newTransactions.list | ranges::to_vector;
+      transactions.list = newTransactions.list | ranges::views::transform(share) | ranges::to_vector;
       transactions.previousId = std::move(newTransactions.previousId);
       changed = true;
     } else if (i != newTransactions.list.cbegin()) {
-      transactions.list.insert(begin(transactions.list), newTransactions.list.cbegin(), i);
+      auto added = ranges::make_subrange(newTransactions.list.cbegin(), i) | ranges::views::transform(share);
+      transactions.list.insert(begin(transactions.list), added.begin(), added.end());
       changed = true;
     }
   }
@@ -1327,6 +1362,7 @@ void History::setRowShowDate(not_null<HistoryRow *> row, bool show) {
 }
 
 bool History::takeDecrypted(int index, const std::vector<Ton::Transaction> &decrypted) {
+  WALLET_TRACE_SPAN("History::takeDecrypted");
   auto rowsIt = _rows.find(kMainPageKey);
   auto transactionsIt = _transactions.find(kMainPageKey);
   Expects(rowsIt != _rows.end() && transactionsIt != _transactions.end());
@@ -1335,23 +1371,23 @@ bool History::takeDecrypted(int index, const std::vector<Ton::Transaction> &decr
 
   Expects(index >= 0 && index < transactions.list.size());
   Expects(index >= 0 && index < rows.regular.size());
-  Expects(rows.regular[index]->id() == transactions.list[index].id);
+  Expects(rows.regular[index]->id() == transactions.list[index]->id);
 
-  const auto i = ranges::find(decrypted, transactions.list[index].id, &Ton::Transaction::id);
+  const auto i = ranges::find(decrypted, transactions.list[index]->id, &Ton::Transaction::id);
   if (i == end(decrypted)) {
     return false;
   }
   if (IsEncryptedMessage(*i)) {
     rows.regular[index]->setDecryptionFailed();
   } else {
-    transactions.list[index] = *i;
-    rows.regular[index] = makeRow(*i);
+    transactions.list[index] = std::make_shared<const Ton::Transaction>(*i);
+    rows.regular[index] = makeRow(transactions.list[index]);
   }
   return true;
 }
 
-std::unique_ptr<HistoryRow> History::makeRow(const Ton::Transaction &data) {
-  const auto id = data.id;
+std::unique_ptr<HistoryRow> History::makeRow(const TransactionPtr &data) {
+  const auto id = data->id;
   if (id.lt == 0) {
     // pending
     return std::make_unique<HistoryRow>(data);
@@ -1392,7 +1428,7 @@ void History::refreshShowDates(const SelectedAsset &selectedAsset) {
   auto filterTransaction = [&, targetAddress = targetAddress, pageAddress = page.second](
                                const SelectedAsset &selectedAsset, bool briefNotifications,
                                not_null<HistoryRow *> row) {
-    auto &transaction = row->transaction();
+    const auto &transaction = row->transaction();
 
     const auto isUnprocessed = transactions == nullptr ||  //
                                transaction.id.lt < transactions->leastScannedTransactionLt ||
@@ -1439,7 +1475,7 @@ void History::refreshShowDates(const SelectedAsset &selectedAsset) {
                       showButton ? [=] { _executeSwapBackRequests.fire(&address); } : Fn<void()>{nullptr});
                 },
                 [&](auto &&) {
-                  const auto asReturnedChange = !transaction.incoming.source.isEmpty() &&
+                  const auto asReturnedChange = row->summary().incoming &&
                                                 v::is<Ton::RegularTransaction>(transaction.additional) &&
                                                 (_knownContracts.contains(transaction.incoming.source) ||
                                                  _tokenOwners.find(transaction.incoming.source) != _tokenOwners.end());
@@ -1448,14 +1484,13 @@ void History::refreshShowDates(const SelectedAsset &selectedAsset) {
           } else {
             v::match(
                 transaction.additional,
-                [&](Ton::TokenTransfer &tokenTransfer) {
+                [&](const Ton::TokenTransfer &tokenTransfer) {
                   if (!tokenTransfer.direct) {
                     return;
                   }
                   const auto it = _tokenOwners.find(tokenTransfer.address);
                   if (it != _tokenOwners.end()) {
-                    tokenTransfer.address = it->second;
-                    tokenTransfer.direct = false;
+                    row->setTokenTransferOwner(it->second);
                   } else if (isUnprocessed) {
                     unknownOwners.insert(tokenTransfer.address);
                   }
@@ -1467,7 +1502,7 @@ void History::refreshShowDates(const SelectedAsset &selectedAsset) {
         [&](const SelectedDePool &selectedDePool) {
           auto maybeDePool = false;
 
-          const auto incoming = !transaction.incoming.source.isEmpty();
+          const auto incoming = row->summary().incoming;
           if (incoming && transaction.incoming.source == targetAddress) {
             maybeDePool = true;
           } else if (!incoming && !transaction.aborted) {
@@ -1577,7 +1612,9 @@ void History::refreshPending() {
   if (_pendingDataChanged) {
     pendingRows =                                                                                            //
         ranges::views::all(_pendingData)                                                                     //
-        | ranges::views::transform([&](const Ton::PendingTransaction &data) { return makeRow(data.fake); })  //
+        | ranges::views::transform([&](const Ton::PendingTransaction &data) {
+            return makeRow(std::make_shared<const Ton::Transaction>(data.fake));
+          })  //
         | ranges::to_vector;
   }
 
@@ -1594,21 +1631,23 @@ void History::refreshRows(const SelectedAsset &selectedAsset) {
   using RowItem = std::decay_t<decltype(_rows.begin()->second.regular.front())>;
 
   auto mergeTransactions = [&](std::vector<std::unique_ptr<HistoryRow>> &rows,
-                               const std::vector<Ton::Transaction> &transactions,
-                               const Fn<RowItem(const Ton::Transaction &)> &makeRow) {
+                               const std::vector<TransactionPtr> &transactions,
+                               const Fn<RowItem(const TransactionPtr &)> &makeRow) {
     auto addedFront = std::vector<std::unique_ptr<HistoryRow>>();
     auto addedBack = std::vector<std::unique_ptr<HistoryRow>>();
     for (const auto &element : transactions) {
-      if (!rows.empty() && element.id == rows.front()->id()) {
+      if (!rows.empty() && element->id == rows.front()->id()) {
         break;
       }
       addedFront.push_back(makeRow(element));
     }
     if (!rows.empty()) {
-      const auto from = ranges::find(transactions, rows.back()->id(), &Ton::Transaction::id);
+      const auto lastId = rows.back()->id();
+      const auto from =
+          ranges::find_if(transactions, [&](const TransactionPtr &element) { return element->id == lastId; });
       if (from != end(transactions)) {
-        addedBack = ranges::make_subrange(from + 1, end(transactions))                                       //
-                    | ranges::views::transform([&](const Ton::Transaction &data) { return makeRow(data); })  //
+        addedBack = ranges::make_subrange(from + 1, end(transactions))                                     //
+                    | ranges::views::transform([&](const TransactionPtr &data) { return makeRow(data); })  //
                     | ranges::to_vector;
       }
     }
@@ -1644,7 +1683,8 @@ void History::refreshRows(const SelectedAsset &selectedAsset) {
                    .first;
     }
     if (page == kMainPageKey) {
-      mergeTransactions(rowsIt->second.regular, transactions.list, [&](const Ton::Transaction &transaction) {
+      mergeTransactions(rowsIt->second.regular, transactions.list, [&](const TransactionPtr &data) {
+        const auto &transaction = *data;
         v::match(
             transaction.additional,  //
             [&](const Ton::TokenWalletDeployed &event) {
@@ -1666,11 +1706,11 @@ void History::refreshRows(const SelectedAsset &selectedAsset) {
               }
             },
             [](auto &&) {});
-        return makeRow(transaction);
+        return makeRow(data);
       });
     } else {
       mergeTransactions(rowsIt->second.regular, transactions.list,
-                        [&](const Ton::Transaction &transaction) { return makeRow(transaction); });
+                        [&](const TransactionPtr &transaction) { return makeRow(transaction); });
     }
   }
 
@@ -1708,39 +1748,131 @@ HistoryPageKey History::currentPage() const {
       [&](const SelectedMultisig &multisig) { return accountPageKey(multisig.address); });
 }
 
+namespace {
+
+struct HistoryPageStamp {
+  Ton::TransactionId first;
+  Ton::TransactionId previous;
+  size_t count = 0;
+};
+
+[[nodiscard]] bool operator==(const HistoryPageStamp &a, const HistoryPageStamp &b) {
+  return a.first == b.first && a.previous == b.previous && a.count == b.count;
+}
+
+// Remembers what was already passed to the History, so that unchanged pages
+// are skipped by comparing stamps and known contracts are updated incrementally.
+class HistoryStateBuilder final {
+ public:
+  [[nodiscard]] HistoryState build(Ton::WalletViewerState &&state);
+
+ private:
+  void addPage(HistoryState &result, HistoryPageKey &&page, Ton::TransactionsSlice &&slice);
+  bool updateContracts(base::flat_map<QString, std::vector<QString>> &&sources);
+
+  base::flat_map<HistoryPageKey, HistoryPageStamp> _pages;
+  base::flat_map<QString, std::vector<QString>> _contractSources;
+  QHash<QString, int> _contractReferences;
+  QSet<QString> _knownContracts;
+  std::map<QString, int64> _multisigTimeouts;
+  bool _initialized = false;
+};
+
+HistoryState HistoryStateBuilder::build(Ton::WalletViewerState &&state) {
+  auto &wallet = state.wallet;
+  auto result = HistoryState{.pendingTransactions = std::move(wallet.pendingTransactions)};
+  auto contracts = base::flat_map<QString, std::vector<QString>>();
+  auto multisigTimeouts = std::map<QString, int64>();
+
+  addPage(result, HistoryPageKey(kMainPageKey), std::move(wallet.lastTransactions));
+
+  for (const auto &[address, dePool] : wallet.dePoolParticipantStates) {
+    contracts.emplace(address, std::vector<QString>{address});
+  }
+
+  for (auto &&[address, multisig] : wallet.multisigStates) {
+    addPage(result, accountPageKey(address), std::move(multisig.lastTransactions));
+    multisigTimeouts.emplace(address, multisig.expirationTime);
+  }
+
+  for (auto &&[symbol, token] : wallet.tokenStates) {
+    addPage(result, std::make_pair(symbol, QString{}), std::move(token.lastTransactions));
+    contracts.emplace(symbol.rootContractAddress(), std::vector<QString>{token.walletContractAddress,
+                                                                         token.rootOwnerAddress,
+                                                                         symbol.rootContractAddress()});
+  }
+
+  if (updateContracts(std::move(contracts)) || !_initialized) {
+    result.knownContracts = _knownContracts;
+  }
+  if (multisigTimeouts != _multisigTimeouts || !_initialized) {
+    _multisigTimeouts = multisigTimeouts;
+    result.multisigTimeouts = std::move(multisigTimeouts);
+  }
+  _initialized = true;
+  return result;
+}
+
+void HistoryStateBuilder::addPage(HistoryState &result, HistoryPageKey &&page, Ton::TransactionsSlice &&slice) {
+  const auto stamp = HistoryPageStamp{
+      .first = slice.list.empty() ? Ton::TransactionId() : slice.list.front().id,
+      .previous = slice.previousId,
+      .count = slice.list.size(),
+  };
+  const auto i = _pages.find(page);
+  if (i == _pages.end()) {
+    _pages.emplace(page, stamp);
+  } else if (i->second == stamp) {
+    return;
+  } else {
+    i->second = stamp;
+  }
+  result.lastTransactions.emplace(std::move(page), std::move(slice));
+}
+
+bool HistoryStateBuilder::updateContracts(base::flat_map<QString, std::vector<QString>> &&sources) {
+  auto changed = false;
+  const auto remove = [&](const std::vector<QString> &contracts) {
+    for (const auto &contract : contracts) {
+      if (--_contractReferences[contract] == 0) {
+        _contractReferences.remove(contract);
+        _knownContracts.remove(contract);
+        changed = true;
+      }
+    }
+  };
+  const auto add = [&](const std::vector<QString> &contracts) {
+    for (const auto &contract : contracts) {
+      if (_contractReferences[contract]++ == 0) {
+        _knownContracts.insert(contract);
+        changed = true;
+      }
+    }
+  };
+  for (const auto &[source, contracts] : _contractSources) {
+    const auto i = sources.find(source);
+    if (i == sources.end() || i->second != contracts) {
+      remove(contracts);
+    }
+  }
+  for (const auto &[source, contracts] : sources) {
+    const auto i = _contractSources.find(source);
+    if (i == _contractSources.end() || i->second != contracts) {
+      add(contracts);
+    }
+  }
+  _contractSources = std::move(sources);
+  return changed;
+}
+
+}  // namespace
+
 rpl::producer<HistoryState> MakeHistoryState(rpl::producer<Ton::WalletViewerState> state) {
-  return std::move(state)  //
-         | rpl::map([](Ton::WalletViewerState &&state) {
-             QSet<QString> knownContracts;
-             for (const auto &item : state.wallet.dePoolParticipantStates) {
-               knownContracts.insert(item.first);
-             }
-
-             std::map<QString, int64> multisigTimeouts;
-
-             std::map<HistoryPageKey, Ton::TransactionsSlice> lastTransactions{
-                 {kMainPageKey, state.wallet.lastTransactions}};
-
-             for (auto &&[address, multisig] : state.wallet.multisigStates) {
-               lastTransactions.emplace(std::piecewise_construct, std::forward_as_tuple(accountPageKey(address)),
-                                        std::forward_as_tuple(std::move(multisig.lastTransactions)));
-               multisigTimeouts.emplace(address, multisig.expirationTime);
-             }
-
-             for (auto &&[symbol, token] : state.wallet.tokenStates) {
-               lastTransactions.emplace(std::make_pair(symbol, QString{}), token.lastTransactions);
-               knownContracts.insert(token.walletContractAddress);
-               knownContracts.insert(token.rootOwnerAddress);
-               knownContracts.insert(symbol.rootContractAddress());
-             }
-
-             return HistoryState{
-                 .lastTransactions = std::move(lastTransactions),
-                 .pendingTransactions = std::move(state.wallet.pendingTransactions),
-                 .knownContracts = std::move(knownContracts),
-                 .multisigTimeouts = std::move(multisigTimeouts),
-             };
-           });
+  return DeriveAsync<HistoryState>(std::move(state), [builder = HistoryStateBuilder()](
+                                                         Ton::WalletViewerState &&state) mutable {
+    WALLET_TRACE_SPAN("MakeHistoryState");
+    return builder.build(std::move(state));
+  });
 }
 
 }  // namespace Wallet
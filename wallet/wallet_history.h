@@ -21,11 +21,13 @@ namespace Wallet {
 
 using HistoryPageKey = std::pair<Ton::Symbol, QString>;
 
+// Each state carries only what changed since the previous one:
+// pages with new transactions, and known contracts or multisig timeouts if they differ.
 struct HistoryState {
   std::map<HistoryPageKey, Ton::TransactionsSlice> lastTransactions;
   std::vector<Ton::PendingTransaction> pendingTransactions;
-  QSet<QString> knownContracts;
-  std::map<QString, int64> multisigTimeouts;
+  std::optional<QSet<QString>> knownContracts;
+  std::optional<std::map<QString, int64>> multisigTimeouts;
 };
 
 class HistoryRow;
@@ -47,8 +49,8 @@ class History final {
   void setVisibleTopBottom(int top, int bottom);
 
   [[nodiscard]] rpl::producer<std::pair<HistoryPageKey, Ton::TransactionId>> preloadRequests() const;
-  [[nodiscard]] rpl::producer<Ton::Transaction> viewRequests() const;
-  [[nodiscard]] rpl::producer<Ton::Transaction> decryptRequests() const;
+  [[nodiscard]] rpl::producer<TransactionPtr> viewRequests() const;
+  [[nodiscard]] rpl::producer<TransactionPtr> decryptRequests() const;
   [[nodiscard]] rpl::producer<std::pair<const Ton::Symbol *, const QSet<QString> *>> ownerResolutionRequests() const;
 
   [[nodiscard]] rpl::producer<not_null<const QString *>> dePoolDetailsRequests() const;
@@ -90,11 +92,11 @@ class History final {
   void refreshShowDates(const SelectedAsset &selectedAsset);
   void setRowShowDate(not_null<HistoryRow *> row, bool show = true);
   bool takeDecrypted(int index, const std::vector<Ton::Transaction> &decrypted);
-  [[nodiscard]] std::unique_ptr<HistoryRow> makeRow(const Ton::Transaction &data);
+  [[nodiscard]] std::unique_ptr<HistoryRow> makeRow(const TransactionPtr &data);
   [[nodiscard]] HistoryPageKey currentPage() const;
 
   struct TransactionsState {
-    std::vector<Ton::Transaction> list;
+    std::vector<TransactionPtr> list;
     Ton::TransactionId previousId;
     int64 latestScannedTransactionLt = 0;
     int64 leastScannedTransactionLt = std::numeric_limits<int64>::max();
@@ -128,8 +130,8 @@ class History final {
   std::pair<bool, int> _pressed = std::make_pair(false, -1);
 
   rpl::event_stream<std::pair<HistoryPageKey, Ton::TransactionId>> _preloadRequests;
-  rpl::event_stream<Ton::Transaction> _viewRequests;
-  rpl::event_stream<Ton::Transaction> _decryptRequests;
+  rpl::event_stream<TransactionPtr> _viewRequests;
+  rpl::event_stream<TransactionPtr> _decryptRequests;
   rpl::event_stream<std::pair<const Ton::Symbol *, const QSet<QString> *>> _ownerResolutionRequests;
 
   rpl::event_stream<not_null<const QString *>> _dePoolDetailsRequests;
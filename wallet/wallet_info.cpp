@@ -13,6 +13,7 @@
 #include "wallet/wallet_history.h"
 #include "wallet/wallet_assets_list.h"
 #include "wallet/wallet_depool_info.h"
+#include "wallet/wallet_trace.h"
 #include "ui/rp_widget.h"
 #include "ui/lottie_widget.h"
 #include "ui/widgets/labels.h"
@@ -78,11 +79,11 @@ rpl::producer<std::pair<HistoryPageKey, Ton::TransactionId>> Info::preloadReques
   return _preloadRequests.events();
 }
 
-rpl::producer<Ton::Transaction> Info::viewRequests() const {
+rpl::producer<TransactionPtr> Info::viewRequests() const {
   return _viewRequests.events();
 }
 
-rpl::producer<Ton::Transaction> Info::decryptRequests() const {
+rpl::producer<TransactionPtr> Info::decryptRequests() const {
   return _decryptRequests.events();
 }
 
@@ -113,7 +114,7 @@ rpl::producer<std::pair<QString, int64>> Info::multisigConfirmRequests() const {
 void Info::setupControls(Data &&data) {
   const auto &state = data.state;
   const auto topBar = _widget->lifetime().make_state<TopBar>(
-      _widget.get(), MakeTopBarState(rpl::duplicate(state), rpl::duplicate(data.updates),
+      _widget.get(), MakeTopBarState(rpl::duplicate(state), std::move(data.syncProgress),
                                      rpl::duplicate(_selectedAsset.value()), _widget->lifetime()));
   topBar->actionRequests() | rpl::start_to_stream(_actionRequests, topBar->lifetime());
 
@@ -170,27 +171,22 @@ void Info::setupControls(Data &&data) {
 
   // create ton history page
 
-  // top cover
-  const auto cover = _widget->lifetime().make_state<Cover>(
-      tonHistoryWrapper,
-      MakeCoverState(rpl::duplicate(state), _selectedAsset.value(), data.justCreated, data.useTestNetwork));
-
-  // register top cover events
-  rpl::merge(cover->sendRequests() | rpl::map([] { return Action::Send; }),
-             cover->receiveRequests() | rpl::map([] { return Action::Receive; }),
-             cover->deployRequests() | rpl::map([] { return Action::Deploy; }))  //
-      | rpl::start_to_stream(_actionRequests, cover->lifetime());
+  // cover and empty history are created lazily, because of their animations
+  _selectedAsset.value()                                                                      //
+      | rpl::filter([](const std::optional<SelectedAsset> &asset) { return asset.has_value(); })  //
+      | rpl::take(1)                                                                              //
+      | rpl::start_with_next(
+            [=, share = data.share, justCreated = data.justCreated, useTestNetwork = data.useTestNetwork] {
+              setupAssetPage(tonHistoryWrapper, rpl::duplicate(state), share, justCreated, useTestNetwork);
+            },
+            lifetime());
 
-  // create transactions lists
+  // create transactions lists, history is created right away because it also discovers new assets
   const auto history = _widget->lifetime().make_state<History>(
       tonHistoryWrapper, MakeHistoryState(rpl::duplicate(state)), std::move(loaded), std::move(data.collectEncrypted),
       std::move(data.updateDecrypted), std::move(data.updateWalletOwners), std::move(data.updateNotifications),
       _selectedAsset.value());
 
-  const auto emptyHistory = _widget->lifetime().make_state<EmptyHistory>(
-      tonHistoryWrapper, MakeEmptyHistoryState(rpl::duplicate(state), _selectedAsset.value(), data.justCreated),
-      data.share);
-
   //  const auto dePoolInfo = _widget->lifetime().make_state<DePoolInfo>(
   //      tonHistoryWrapper,
   //      MakeDePoolInfoState(  //
@@ -223,6 +219,7 @@ void Info::setupControls(Data &&data) {
           [=](QSize size, int tokensListHeight, int historyHeight,
               //int dePoolInfoHeight,
               std::optional<SelectedAsset> asset) {
+            WALLET_TRACE_SPAN("Info::layout");
             if (asset.has_value()) {
               const auto [contentHeight, historyVisible, dePoolInfoVisible] = v::match(
                   *asset,
@@ -235,16 +232,18 @@ void Info::setupControls(Data &&data) {
                     return std::make_tuple(historyHeight, historyHeight == 0, false);
                   });
 
-              const auto innerHeight = std::max(size.height(), cover->height() + contentHeight);
+              Assert(_cover != nullptr && _emptyHistory != nullptr);
+
+              const auto innerHeight = std::max(size.height(), _cover->height() + contentHeight);
               _inner->setGeometry({0, 0, size.width(), innerHeight});
 
               const auto coverHeight = st::walletCoverHeight;
 
-              cover->setGeometry(QRect(0, 0, size.width(), coverHeight));
-              emptyHistory->setGeometry(QRect(0, coverHeight, size.width(), size.height() - coverHeight));
+              _cover->setGeometry(QRect(0, 0, size.width(), coverHeight));
+              _emptyHistory->setGeometry(QRect(0, coverHeight, size.width(), size.height() - coverHeight));
               //dePoolInfo->setGeometry(QRect(0, coverHeight, size.width(), size.height() - coverHeight));
 
-              emptyHistory->setVisible(historyVisible);
+              _emptyHistory->setVisible(historyVisible);
               //dePoolInfo->setVisible(dePoolInfoVisible);
 
               tonHistoryWrapper->setGeometry(QRect(0, 0, size.width(), innerHeight));
@@ -288,6 +287,21 @@ void Info::setupControls(Data &&data) {
                                lifetime());
 }
 
+void Info::setupAssetPage(not_null<Ui::RpWidget *> parent, rpl::producer<Ton::WalletViewerState> &&state,
+                          const Fn<void(QImage, QString)> &share, bool justCreated, bool useTestNetwork) {
+  _cover = std::make_unique<Cover>(
+      parent, MakeCoverState(rpl::duplicate(state), _selectedAsset.value(), justCreated, useTestNetwork));
+
+  // register top cover events
+  rpl::merge(_cover->sendRequests() | rpl::map([] { return Action::Send; }),
+             _cover->receiveRequests() | rpl::map([] { return Action::Receive; }),
+             _cover->deployRequests() | rpl::map([] { return Action::Deploy; }))  //
+      | rpl::start_to_stream(_actionRequests, _cover->lifetime());
+
+  _emptyHistory = std::make_unique<EmptyHistory>(
+      parent, MakeEmptyHistoryState(std::move(state), _selectedAsset.value(), justCreated), share);
+}
+
 rpl::lifetime &Info::lifetime() {
   return _widget->lifetime();
 }
@@ -22,13 +22,15 @@ using HistoryPageKey = std::pair<Ton::Symbol, QString>;
 
 enum class Action;
 enum class InfoTransition;
+class Cover;
+class EmptyHistory;
 
 class Info final {
  public:
   struct Data {
     rpl::producer<Ton::WalletViewerState> state;
     rpl::producer<Ton::Result<std::pair<HistoryPageKey, Ton::LoadedSlice>>> loaded;
-    rpl::producer<Ton::Update> updates;
+    rpl::producer<SyncProgress> syncProgress;
     rpl::producer<not_null<std::vector<Ton::Transaction> *>> collectEncrypted;
     rpl::producer<not_null<const std::vector<Ton::Transaction> *>> updateDecrypted;
     rpl::producer<not_null<std::map<QString, QString> *>> updateWalletOwners;
@@ -50,8 +52,8 @@ class Info final {
   [[nodiscard]] rpl::producer<CustomAsset> removeAssetRequests() const;
   [[nodiscard]] rpl::producer<std::pair<HistoryPageKey, Ton::TransactionId>> preloadRequests() const;
   [[nodiscard]] rpl::producer<std::pair<int, int>> assetsReorderRequests() const;
-  [[nodiscard]] rpl::producer<Ton::Transaction> viewRequests() const;
-  [[nodiscard]] rpl::producer<Ton::Transaction> decryptRequests() const;
+  [[nodiscard]] rpl::producer<TransactionPtr> viewRequests() const;
+  [[nodiscard]] rpl::producer<TransactionPtr> decryptRequests() const;
   [[nodiscard]] rpl::producer<std::pair<const Ton::Symbol *, const QSet<QString> *>> ownerResolutionRequests() const;
 
   [[nodiscard]] rpl::producer<not_null<const QString *>> dePoolDetailsRequests() const;
@@ -65,6 +67,8 @@ class Info final {
 
  private:
   void setupControls(Data &&data);
+  void setupAssetPage(not_null<Ui::RpWidget *> parent, rpl::producer<Ton::WalletViewerState> &&state,
+                      const Fn<void(QImage, QString)> &share, bool justCreated, bool useTestNetwork);
 
   const std::unique_ptr<Ui::RpWidget> _widget;
   const not_null<Ui::ScrollArea *> _scroll;
@@ -72,12 +76,16 @@ class Info final {
 
   rpl::variable<std::optional<SelectedAsset>> _selectedAsset;
 
+  // Created when an asset is opened for the first time.
+  std::unique_ptr<Cover> _cover;
+  std::unique_ptr<EmptyHistory> _emptyHistory;
+
   rpl::event_stream<Action> _actionRequests;
   rpl::event_stream<CustomAsset> _removeAssetRequests;
   rpl::event_stream<std::pair<int, int>> _assetsReorderRequests;
   rpl::event_stream<std::pair<HistoryPageKey, Ton::TransactionId>> _preloadRequests;
-  rpl::event_stream<Ton::Transaction> _viewRequests;
-  rpl::event_stream<Ton::Transaction> _decryptRequests;
+  rpl::event_stream<TransactionPtr> _viewRequests;
+  rpl::event_stream<TransactionPtr> _decryptRequests;
   rpl::event_stream<std::pair<const Ton::Symbol *, const QSet<QString> *>> _ownerResolutionRequests;
 
   rpl::event_stream<not_null<const QString *>> _dePoolDetailsRequests;
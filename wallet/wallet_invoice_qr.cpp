@@ -37,34 +37,47 @@ void InvoiceQrBox(not_null<Ui::GenericBox *> box, const QString &link, const Fn<
 
   const auto button = Ui::CreateChild<Ui::AbstractButton>(container);
 
-  auto qr = button->lifetime().make_state<QImage>();
-  *qr = Ui::TokenQr(symbol, link, st::walletInvoiceQrPixel,
-                    st::boxWidth - st::boxRowPadding.left() - st::boxRowPadding.right());
-
-  const int size = qr->width() / style::DevicePixelRatio();
+  const auto qr = button->lifetime().make_state<QImage>();
+  const auto size = Ui::TokenQrSize(link, st::walletInvoiceQrPixel,
+                                    st::boxWidth - st::boxRowPadding.left() - st::boxRowPadding.right());
   const auto height = st::walletInvoiceQrSkip * 2 + size;
 
   container->setFixedHeight(height);
 
   button->resize(size, size);
 
-  button->setClickedCallback([=, symbol = symbol] { share(Ui::TokenQrForShare(symbol, link), QString()); });
+  Ui::TokenQrValue(symbol, link, st::walletInvoiceQrPixel,
+                   st::boxWidth - st::boxRowPadding.left() - st::boxRowPadding.right())  //
+      | rpl::start_with_next(
+            [=](QImage &&image) {
+              *qr = std::move(image);
+              button->update();
+            },
+            button->lifetime());
+
+  const auto shareQr = [=, symbol = symbol] {
+    Ui::TokenQrForShareValue(symbol, link)  //
+        | rpl::take(1)                      //
+        | rpl::start_with_next([=](QImage &&image) { share(std::move(image), QString()); }, button->lifetime());
+  };
+
+  button->setClickedCallback(shareQr);
 
   button->paintRequest()  //
       | rpl::start_with_next(
             [=] {
-              const auto size = qr->width() / style::DevicePixelRatio();
-              QPainter(button).drawImage(QRect(0, 0, size, size), *qr);
+              auto p = QPainter(button);
+              if (qr->isNull()) {
+                p.fillRect(QRect(0, 0, size, size), st::windowBgOver);
+              } else {
+                p.drawImage(QRect(0, 0, size, size), *qr);
+              }
             },
             button->lifetime());
 
   container->widthValue()  //
-      | rpl::start_with_next(
-            [=](int width) {
-              const auto size = qr->width() / style::DevicePixelRatio();
-              button->move((width - size) / 2, st::walletInvoiceQrSkip);
-            },
-            button->lifetime());
+      | rpl::start_with_next([=](int width) { button->move((width - size) / 2, st::walletInvoiceQrSkip); },
+                             button->lifetime());
 
   AddBoxSubtitle(box, ph::lng_wallet_invoice_qr_amount());
 
@@ -79,7 +92,7 @@ void InvoiceQrBox(not_null<Ui::GenericBox *> box, const QString &link, const Fn<
 
   box->addButton(
          ph::lng_wallet_invoice_qr_share(),
-         [=, symbol = symbol] { share(Ui::TokenQrForShare(symbol, link), QString()); }, st::walletBottomButton)
+         shareQr, st::walletBottomButton)
       ->setTextTransform(Ui::RoundButton::TextTransform::NoTransform);
 }
 
@@ -13,6 +13,7 @@
 #include "styles/style_wallet.h"
 #include "wallet/wallet_common.h"
 #include "wallet/wallet_phrases.h"
+#include "wallet/wallet_words.h"
 #include "wallet/create/wallet_create_view.h"
 #include "base/platform/base_platform_layout_switch.h"
 #include "ton/ton_wallet.h"
@@ -23,11 +24,6 @@ namespace {
 
 using TonWordInput = Ui::TonWordInput;
 
-const base::flat_set<QString> &ValidWords() {
-  static auto words = Ton::Wallet::GetValidWords();
-  return words;
-}
-
 style::TextStyle ComputePubKeyStyle(const style::TextStyle &parent) {
   auto result = parent;
   result.font = result.font->monospace();
@@ -89,38 +85,6 @@ not_null<Ui::RpWidget *> CreatePubKeyLabel(not_null<Ui::RpWidget *> parent, rpl:
   return result;
 }
 
-std::vector<QString> WordsByPrefix(const QString &word) {
-  const auto &validWords = ValidWords();
-
-  const auto adjusted = word.trimmed().toLower();
-  if (adjusted.isEmpty()) {
-    return {};
-  } else if (validWords.empty()) {
-    return {word};
-  }
-  auto prefix = QString();
-  auto count = 0;
-  auto maxCount = 0;
-  for (const auto &validWord : validWords) {
-    if (validWord.midRef(0, 3) != prefix) {
-      prefix = validWord.mid(0, 3);
-      count = 1;
-    } else {
-      ++count;
-    }
-    if (maxCount < count) {
-      maxCount = count;
-    }
-  }
-  auto result = std::vector<QString>();
-  const auto from = ranges::lower_bound(validWords, adjusted);
-  const auto end = validWords.end();
-  for (auto i = from; i != end && i->startsWith(adjusted); ++i) {
-    result.push_back(*i);
-  }
-  return result;
-}
-
 }  // namespace
 
 class KeystoreItem {
@@ -388,18 +352,21 @@ void ImportFtabiKeyBox(not_null<Ui::GenericBox *> box, const Fn<void()> &cancel,
 
     word.pasted()  //
         | rpl::start_with_next(
-              [=](QString text) {
-                text = text.simplified();
-                int cnt = 0;
-                for (const auto &w : text.split(' ')) {
-                  if (index + cnt < count) {
-                    (*inputs)[index + cnt]->setText(w);
-                    (*inputs)[index + cnt]->setFocus();
-                    cnt++;
-                  } else {
-                    break;
+              [=](const QString &text) {
+                const auto phrase = CheckPhrase(text);
+                const auto pasted = std::min(int(phrase.size()), count - index);
+                auto invalid = -1;
+                for (auto i = 0; i != pasted; ++i) {
+                  (*inputs)[index + i]->setText(phrase[i].word);
+                  (*inputs)[index + i]->setFocus();
+                  if (!phrase[i].valid && invalid < 0) {
+                    invalid = i;
                   }
                 }
+                if (invalid >= 0) {
+                  auto hints = phrase[invalid].hints;
+                  (*inputs)[index + invalid]->showCorrections(std::move(hints));
+                }
               },
               box->lifetime());
 
@@ -435,7 +402,7 @@ void ImportFtabiKeyBox(not_null<Ui::GenericBox *> box, const Fn<void()> &cancel,
   };
 
   for (auto i = 0; i != count; ++i) {
-    inputs->push_back(std::make_unique<TonWordInput>(widget, st::walletImportInputField, i, WordsByPrefix));
+    inputs->push_back(std::make_unique<TonWordInput>(widget, st::walletImportInputField, i, WordSuggestions));
     init(*inputs->back(), i);
   }
 
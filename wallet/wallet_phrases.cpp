@@ -207,6 +207,8 @@ phrase lng_wallet_invoice_copied = "Invoice link copied to clipboard.";
 
 phrase lng_wallet_menu_settings = "Settings";
 phrase lng_wallet_menu_keystore = "Key storage";
+phrase lng_wallet_menu_batch_transfer = "Batch transfer";
+phrase lng_wallet_menu_confirm_multisig = "Confirm pending transactions";
 phrase lng_wallet_menu_change_passcode = "Change password";
 phrase lng_wallet_menu_export = "Back up wallet";
 phrase lng_wallet_menu_delete = "Log Out";
@@ -281,6 +283,31 @@ phrase lng_wallet_send_failed_title = "Sending failed";
 phrase lng_wallet_send_failed_text =
     "Could not perform the transaction. Please check your wallet's balance and try again.";
 
+phrase lng_wallet_batch_transfer_title = "Batch transfer";
+phrase lng_wallet_batch_transfer_summary =
+    "Recipients: {count}, total: {amount}\n"
+    "Checked: {checked}, sent: {sent}, failed: {failed}\n"
+    "Fees: {fees}";
+phrase lng_wallet_batch_transfer_checking = "checking...";
+phrase lng_wallet_batch_transfer_fee = "fee {amount}";
+phrase lng_wallet_batch_transfer_sending = "sending...";
+phrase lng_wallet_batch_transfer_sent = "sent";
+phrase lng_wallet_batch_transfer_failed = "failed: {error}";
+phrase lng_wallet_batch_transfer_invalid_address = "invalid address";
+phrase lng_wallet_batch_transfer_invalid_amount = "invalid amount";
+phrase lng_wallet_batch_transfer_invalid_comment = "invalid comment";
+phrase lng_wallet_batch_transfer_recipient_not_found = "recipient token wallet not found";
+phrase lng_wallet_batch_transfer_button = "Send {count} transfers";
+phrase lng_wallet_batch_transfer_stop = "Stop";
+phrase lng_wallet_batch_transfer_shortfall = "Not enough funds, {amount} more needed";
+phrase lng_wallet_batch_transfer_empty =
+    "No transfers found. Every line of the file should look like:\naddress,amount,comment";
+phrase lng_wallet_batch_transfer_read_error = "Could not read the file.";
+
+phrase lng_wallet_multisig_confirm_batch_title = "Confirm transactions";
+phrase lng_wallet_multisig_confirm_batch_button = "Confirm {count} transactions";
+phrase lng_wallet_multisig_confirm_batch_empty = "There are no pending transactions waiting for confirmation.";
+
 phrase lng_wallet_add_depool_succeeded = "DePool added successfully!";
 phrase lng_wallet_add_depool_failed_title = "Failed to add DePool";
 phrase lng_wallet_add_depool_failed_text =
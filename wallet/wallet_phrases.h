@@ -200,6 +200,8 @@ extern phrase lng_wallet_invoice_copied;
 
 extern phrase lng_wallet_menu_settings;
 extern phrase lng_wallet_menu_keystore;
+extern phrase lng_wallet_menu_batch_transfer;
+extern phrase lng_wallet_menu_confirm_multisig;
 extern phrase lng_wallet_menu_change_passcode;
 extern phrase lng_wallet_menu_export;
 extern phrase lng_wallet_menu_delete;
@@ -266,6 +268,27 @@ extern phrase lng_wallet_collect_tokens_button;
 extern phrase lng_wallet_send_failed_title;
 extern phrase lng_wallet_send_failed_text;
 
+extern phrase lng_wallet_batch_transfer_title;
+extern phrase lng_wallet_batch_transfer_summary;
+extern phrase lng_wallet_batch_transfer_checking;
+extern phrase lng_wallet_batch_transfer_fee;
+extern phrase lng_wallet_batch_transfer_sending;
+extern phrase lng_wallet_batch_transfer_sent;
+extern phrase lng_wallet_batch_transfer_failed;
+extern phrase lng_wallet_batch_transfer_invalid_address;
+extern phrase lng_wallet_batch_transfer_invalid_amount;
+extern phrase lng_wallet_batch_transfer_invalid_comment;
+extern phrase lng_wallet_batch_transfer_recipient_not_found;
+extern phrase lng_wallet_batch_transfer_button;
+extern phrase lng_wallet_batch_transfer_stop;
+extern phrase lng_wallet_batch_transfer_shortfall;
+extern phrase lng_wallet_batch_transfer_empty;
+extern phrase lng_wallet_batch_transfer_read_error;
+
+extern phrase lng_wallet_multisig_confirm_batch_title;
+extern phrase lng_wallet_multisig_confirm_batch_button;
+extern phrase lng_wallet_multisig_confirm_batch_empty;
+
 extern phrase lng_wallet_add_depool_succeeded;
 extern phrase lng_wallet_add_depool_failed_title;
 extern phrase lng_wallet_add_depool_failed_text;
@@ -42,21 +42,37 @@ void ReceiveTokensBox(not_null<Ui::GenericBox *> box, RecipientWalletType type,
 
   const auto container = box->addRow(object_ptr<Ui::AbstractButton>(box));
 
-  container->setClickedCallback(
-      [=, symbol = symbol] { share(Ui::TokenQrForShare(symbol, TransferLink(rawAddress, symbol)), QString()); });
+  const auto link = TransferLink(rawAddress, symbol);
 
-  auto qr = container->lifetime().make_state<QImage>();
+  container->setClickedCallback([=, symbol = symbol] {
+    Ui::TokenQrForShareValue(symbol, link)  //
+        | rpl::take(1)                      //
+        | rpl::start_with_next([=](QImage &&image) { share(std::move(image), QString()); }, container->lifetime());
+  });
 
-  const auto link = TransferLink(rawAddress, symbol);
-  *qr = Ui::TokenQr(symbol, link, st::walletReceiveQrPixel);
-  const auto size = qr->width() / style::DevicePixelRatio();
+  const auto qr = container->lifetime().make_state<QImage>();
+
+  const auto size = Ui::TokenQrSize(link, st::walletReceiveQrPixel);
   container->resize(size, size);
 
+  Ui::TokenQrValue(symbol, link, st::walletReceiveQrPixel)  //
+      | rpl::start_with_next(
+            [=](QImage &&image) {
+              *qr = std::move(image);
+              container->update();
+            },
+            container->lifetime());
+
   container->paintRequest() |
       rpl::start_with_next(
           [=] {
-            const auto size = qr->width() / style::DevicePixelRatio();
-            QPainter(container).drawImage(QRect((container->width() - size) / 2, 0, size, size), *qr);
+            auto p = QPainter(container);
+            const auto rect = QRect((container->width() - size) / 2, 0, size, size);
+            if (qr->isNull()) {
+              p.fillRect(rect, st::windowBgOver);
+            } else {
+              p.drawImage(rect, *qr);
+            }
           },
           container->lifetime());
 
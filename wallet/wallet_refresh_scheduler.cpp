@@ -0,0 +1,111 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "wallet/wallet_refresh_scheduler.h"
+
+#include "wallet/wallet_trace.h"
+#include "base/last_user_input.h"
+
+namespace Wallet {
+namespace {
+
+constexpr auto kRefreshWhileSendingDelay = 3 * crl::time(1000);
+constexpr auto kRefreshEachDelay = 10 * crl::time(1000);
+constexpr auto kRefreshInactiveDelay = 60 * crl::time(1000);
+constexpr auto kRefreshFailedDelay = 5 * crl::time(1000);
+constexpr auto kRefreshFailedMaxDelay = 5 * 60 * crl::time(1000);
+constexpr auto kMaxFailedShift = 10;
+constexpr auto kJitter = 0.1;
+
+}  // namespace
+
+RefreshScheduler::RefreshScheduler(Refresh refresh)
+    : _refresh(std::move(refresh))
+    , _lastRefresh(crl::now())
+    , _generator(std::random_device()())
+    , _timer([=] {
+      if (const auto left = refreshIn(crl::now()); left > 0) {
+        _timer.callOnce(left);
+      } else {
+        this->refresh();
+      }
+    }) {
+  updateJitter();
+}
+
+void RefreshScheduler::setState(const Ton::WalletViewerState &state) {
+  WALLET_TRACE_SPAN("RefreshScheduler::setState");
+  const auto &wallet = state.wallet;
+  _pending = !wallet.pendingTransactions.empty() ||
+             ranges::any_of(wallet.multisigStates,
+                            [](const auto &pair) { return !pair.second.pendingTransactions.empty(); });
+
+  _viewerRefreshing = state.refreshing;
+  if (state.lastRefresh > _lastRefresh) {
+    _lastRefresh = state.lastRefresh;
+    _failures = 0;
+    updateJitter();
+  }
+  schedule();
+}
+
+void RefreshScheduler::setForeground(bool foreground) {
+  if (_foreground != foreground) {
+    _foreground = foreground;
+    schedule();
+  }
+}
+
+void RefreshScheduler::schedule() {
+  if (_refreshing || _viewerRefreshing) {
+    _timer.cancel();
+    return;
+  }
+  _timer.callOnce(std::max(refreshIn(crl::now()), crl::time(0)));
+}
+
+void RefreshScheduler::refresh() {
+  WALLET_TRACE_SPAN("RefreshScheduler::refresh");
+  _refreshing = true;
+  _refresh(crl::guard(this, [=](bool success) { refreshed(success); }));
+}
+
+void RefreshScheduler::refreshed(bool success) {
+  _refreshing = false;
+  if (success) {
+    _lastRefresh = std::max(_lastRefresh, crl::now());
+    _failures = 0;
+  } else {
+    _lastFailure = crl::now();
+    ++_failures;
+  }
+  updateJitter();
+  schedule();
+}
+
+void RefreshScheduler::updateJitter() {
+  _jitter = std::uniform_real_distribution<float64>(1. - kJitter, 1. + kJitter)(_generator);
+}
+
+crl::time RefreshScheduler::delay() const {
+  if (_pending) {
+    return kRefreshWhileSendingDelay;
+  } else if (!_foreground || base::SinceLastUserInput() > kRefreshEachDelay) {
+    return kRefreshInactiveDelay;
+  }
+  return kRefreshEachDelay;
+}
+
+crl::time RefreshScheduler::refreshIn(crl::time now) const {
+  auto when = _lastRefresh + crl::time(delay() * _jitter);
+  if (_failures > 0) {
+    const auto backoff = std::min(kRefreshFailedDelay << std::min(_failures - 1, kMaxFailedShift), kRefreshFailedMaxDelay);
+    when = std::max(when, _lastFailure + crl::time(backoff * _jitter));
+  }
+  return when - now;
+}
+
+}  // namespace Wallet
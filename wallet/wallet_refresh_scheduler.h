@@ -0,0 +1,55 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "wallet_common.h"
+
+#include "base/timer.h"
+#include "base/weak_ptr.h"
+
+#include <random>
+
+namespace Wallet {
+
+// Refreshes the wallet often while transactions are pending and rarely
+// while the window is inactive or the user is idle. Failed refreshes back
+// off exponentially, every delay gets a small random jitter.
+//
+// Account viewer refreshes the whole wallet at once, so all assets share
+// one delay: this spreads and backs off the requests, but does not reduce
+// their number for wallets with many assets.
+class RefreshScheduler final : public base::has_weak_ptr {
+ public:
+  using Refresh = Fn<void(Fn<void(bool success)> done)>;
+
+  explicit RefreshScheduler(Refresh refresh);
+
+  void setState(const Ton::WalletViewerState &state);
+  void setForeground(bool foreground);
+
+ private:
+  void schedule();
+  void refresh();
+  void refreshed(bool success);
+  void updateJitter();
+  [[nodiscard]] crl::time delay() const;
+  [[nodiscard]] crl::time refreshIn(crl::time now) const;
+
+  const Refresh _refresh;
+  bool _pending = false;
+  bool _foreground = true;
+  bool _refreshing = false;
+  bool _viewerRefreshing = false;
+  crl::time _lastRefresh = 0;
+  crl::time _lastFailure = 0;
+  int _failures = 0;
+  float64 _jitter = 1.;
+  std::mt19937 _generator;
+  base::Timer _timer;
+};
+
+}  // namespace Wallet
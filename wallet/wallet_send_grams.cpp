@@ -15,6 +15,7 @@
 #include "ui/inline_token_icon.h"
 #include "base/algorithm.h"
 #include "base/qt_signal_producer.h"
+#include "base/timer.h"
 #include "styles/style_wallet.h"
 #include "styles/style_layers.h"
 #include "styles/palette.h"
@@ -25,6 +26,8 @@
 namespace Wallet {
 namespace {
 
+constexpr auto kEstimateDelay = crl::time(500);
+
 struct FixedAddress {
   QString address{};
   int position = 0;
@@ -51,7 +54,7 @@ struct FixedAddress {
 
 template <typename T>
 void SendGramsBox(not_null<Ui::GenericBox *> box, const T &invoice, rpl::producer<Ton::WalletState> state,
-                  const Fn<void(const T &, Fn<void(InvoiceField)> error)> &done) {
+                  const Fn<void(const T &, Fn<void(InvoiceField)> error)> &done, const Fn<void(const T &)> &estimate) {
   constexpr auto isTonTransfer = std::is_same_v<T, TonTransferInvoice>;
   constexpr auto isTokenTransfer = std::is_same_v<T, TokenTransferInvoice>;
   constexpr auto isMsigTransfer = std::is_same_v<T, MultisigSubmitTransactionInvoice>;
@@ -273,12 +276,11 @@ void SendGramsBox(not_null<Ui::GenericBox *> box, const T &invoice, rpl::produce
     Unexpected("Field value in SendGramsBox error callback.");
   });
 
-  const auto submit = [=] {
+  const auto collect = [=]() -> std::optional<T> {
     auto collected = *prepared;
     const auto parsed = ParseAmountString(amount->getLastText(), tokenDecimals);
     if (!parsed) {
-      amount->showError();
-      return;
+      return std::nullopt;
     }
     collected.address = address->getLastText();
     if constexpr (isTonTransfer || isMsigTransfer) {
@@ -291,7 +293,15 @@ void SendGramsBox(not_null<Ui::GenericBox *> box, const T &invoice, rpl::produce
       collected.callbackAddress = callbackAddress->getLastText();
       collected.transferType = transferType->current();
     }
-    done(collected, showError);
+    return collected;
+  };
+
+  const auto submit = [=] {
+    if (const auto collected = collect()) {
+      done(*collected, showError);
+    } else {
+      amount->showError();
+    }
   };
 
   box->addButton(std::move(text), submit, st::walletBottomButton)
@@ -420,18 +430,38 @@ void SendGramsBox(not_null<Ui::GenericBox *> box, const T &invoice, rpl::produce
   if (callbackAddressWrapper != nullptr && !isEthereumAddress->current()) {
     callbackAddressWrapper->setMaximumHeight(0);
   }
+
+  if (estimate) {
+    // Check the transfer in the background once the input settles,
+    // so the confirmation can show the fees without waiting.
+    const auto estimateTimer = box->lifetime().make_state<base::Timer>([=] {
+      if (const auto collected = collect()) {
+        estimate(*collected);
+      }
+    });
+    const auto scheduleEstimate = [=] { estimateTimer->callOnce(kEstimateDelay); };
+    for (const auto field : std::vector<Ui::InputField *>{address, amount, comment, callbackAddress}) {
+      if (field != nullptr) {
+        Ui::Connect(field, &Ui::InputField::changed, scheduleEstimate);
+      }
+    }
+    scheduleEstimate();
+  }
 }
 
 template void SendGramsBox(not_null<Ui::GenericBox *> box, const TonTransferInvoice &invoice,
                            rpl::producer<Ton::WalletState> state,
-                           const Fn<void(const TonTransferInvoice &, Fn<void(InvoiceField)>)> &done);
+                           const Fn<void(const TonTransferInvoice &, Fn<void(InvoiceField)>)> &done,
+                           const Fn<void(const TonTransferInvoice &)> &estimate);
 
 template void SendGramsBox(not_null<Ui::GenericBox *> box, const TokenTransferInvoice &invoice,
                            rpl::producer<Ton::WalletState> state,
-                           const Fn<void(const TokenTransferInvoice &, Fn<void(InvoiceField)>)> &done);
+                           const Fn<void(const TokenTransferInvoice &, Fn<void(InvoiceField)>)> &done,
+                           const Fn<void(const TokenTransferInvoice &)> &estimate);
 
 template void SendGramsBox(not_null<Ui::GenericBox *> box, const MultisigSubmitTransactionInvoice &invoice,
                            rpl::producer<Ton::WalletState> state,
-                           const Fn<void(const MultisigSubmitTransactionInvoice &, Fn<void(InvoiceField)>)> &done);
+                           const Fn<void(const MultisigSubmitTransactionInvoice &, Fn<void(InvoiceField)>)> &done,
+                           const Fn<void(const MultisigSubmitTransactionInvoice &)> &estimate);
 
 }  // namespace Wallet
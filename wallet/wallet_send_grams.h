@@ -22,6 +22,6 @@ enum class InvoiceField { Address, Amount, Comment, CallbackAddress };
 
 template <typename T>
 void SendGramsBox(not_null<Ui::GenericBox *> box, const T &invoice, rpl::producer<Ton::WalletState> state,
-                  const Fn<void(const T &, Fn<void(InvoiceField)> error)> &done);
+                  const Fn<void(const T &, Fn<void(InvoiceField)> error)> &done, const Fn<void(const T &)> &estimate);
 
 }  // namespace Wallet
@@ -58,7 +58,20 @@ constexpr auto kMsInMinute = 60 * crl::time(1000);
          | ToTopBarState(selectedAsset);
 }
 
-[[nodiscard]] rpl::producer<TopBarState> MakeNonSyncTopBarState(const Ton::WalletViewerState &state,
+struct RefreshState {
+  bool refreshing = false;
+  crl::time lastRefresh = 0;
+};
+
+bool operator==(const RefreshState &a, const RefreshState &b) {
+  return a.refreshing == b.refreshing && a.lastRefresh == b.lastRefresh;
+}
+
+bool operator!=(const RefreshState &a, const RefreshState &b) {
+  return !(a == b);
+}
+
+[[nodiscard]] rpl::producer<TopBarState> MakeNonSyncTopBarState(const RefreshState &state,
                                                                 const std::optional<SelectedAsset> &selectedAsset) {
   if (state.refreshing || !state.lastRefresh) {
     return MakeTopBarStateRefreshing(selectedAsset);
@@ -114,6 +127,7 @@ void TopBar::setupControls(rpl::producer<TopBarState> &&state) {
             [=](int width, const TopBarState &state) {
               const auto height = _widget.height();
 
+              _selectedAsset = state.selectedAsset;
               const auto isAssetSelected = state.selectedAsset.has_value();
               back->setVisible(isAssetSelected);
               broxus->setVisible(!isAssetSelected);
@@ -160,6 +174,14 @@ void TopBar::showMenu(not_null<Ui::IconButton *> toggle) {
 
   menu->addAction(ph::lng_wallet_menu_settings(ph::now), [=] { _actionRequests.fire(Action::ShowSettings); });
   menu->addAction(ph::lng_wallet_menu_keystore(ph::now), [=] { _actionRequests.fire(Action::ShowKeystore); });
+  // Batch transfers are sent from the main wallet only.
+  if (!_selectedAsset || v::is<SelectedToken>(*_selectedAsset)) {
+    menu->addAction(ph::lng_wallet_menu_batch_transfer(ph::now), [=] { _actionRequests.fire(Action::BatchTransfer); });
+  }
+  if (_selectedAsset && v::is<SelectedMultisig>(*_selectedAsset)) {
+    menu->addAction(ph::lng_wallet_menu_confirm_multisig(ph::now),
+                    [=] { _actionRequests.fire(Action::ConfirmMultisig); });
+  }
   //menu->addAction(ph::lng_wallet_menu_change_passcode(ph::now), [=] { _actionRequests.fire(Action::ChangePassword); });
   //menu->addAction(ph::lng_wallet_menu_export(ph::now), [=] { _actionRequests.fire(Action::Export); });
   menu->addAction(ph::lng_wallet_menu_delete(ph::now), [=] { _actionRequests.fire(Action::LogOut); });
@@ -173,24 +195,21 @@ void TopBar::showMenu(not_null<Ui::IconButton *> toggle) {
 }
 
 rpl::producer<TopBarState> MakeTopBarState(rpl::producer<Ton::WalletViewerState> &&state,
-                                           rpl::producer<Ton::Update> &&updates,
+                                           rpl::producer<SyncProgress> &&syncProgress,
                                            rpl::producer<std::optional<SelectedAsset>> &&selectedAsset,
                                            rpl::lifetime &alive) {
-  auto syncs =                                                                                                 //
-      rpl::single(Ton::SyncState())                                                                            //
-      | rpl::then(std::move(updates)                                                                           //
-                  | rpl::filter([](const Ton::Update &update) { return v::is<Ton::SyncState>(update.data); })  //
-                  | rpl::map([](const Ton::Update &update) { return v::get<Ton::SyncState>(update.data); }));
-
-  return rpl::combine(std::move(state), std::move(syncs), std::move(selectedAsset))  //
-         | rpl::map([=](const Ton::WalletViewerState &state, const Ton::SyncState &sync,
+  auto refresh = Select(std::move(state), [](const Ton::WalletViewerState &state) {
+    return RefreshState{.refreshing = state.refreshing, .lastRefresh = state.lastRefresh};
+  });
+  return rpl::combine(std::move(refresh), std::move(syncProgress), std::move(selectedAsset))  //
+         | rpl::map([=](const RefreshState &state, const SyncProgress &sync,
                         const std::optional<SelectedAsset> &selectedAsset) -> rpl::producer<TopBarState> {
-             if (!sync.valid() || sync.current == sync.to) {
+             if (!sync.syncing()) {
                return MakeNonSyncTopBarState(state, selectedAsset);
-             } else if (sync.current == sync.from) {
+             } else if (sync.phase == SyncPhase::Started) {
                return ph::lng_wallet_sync() | ToTopBarState(selectedAsset);
              } else {
-               const auto percent = QString::number((100 * (sync.current - sync.from) / (sync.to - sync.from)));
+               const auto percent = QString::number(sync.percent);
                return ph::lng_wallet_sync_percent()  //
                       | rpl::map([=](QString &&text) {
                           return TopBarState{
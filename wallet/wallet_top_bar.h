@@ -17,7 +17,6 @@ class DropdownMenu;
 
 namespace Ton {
 struct WalletViewerState;
-struct Update;
 }  // namespace Ton
 
 namespace Wallet {
@@ -46,10 +45,11 @@ class TopBar final {
   Ui::RpWidget _widget;
   rpl::event_stream<Action> _actionRequests;
   base::unique_qptr<Ui::DropdownMenu> _menu;
+  std::optional<SelectedAsset> _selectedAsset;
 };
 
 [[nodiscard]] rpl::producer<TopBarState> MakeTopBarState(rpl::producer<Ton::WalletViewerState> &&state,
-                                                         rpl::producer<Ton::Update> &&updates,
+                                                         rpl::producer<SyncProgress> &&syncProgress,
                                                          rpl::producer<std::optional<SelectedAsset>> &&selectedAsset,
                                                          rpl::lifetime &alive);
 
@@ -0,0 +1,143 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "wallet/wallet_trace.h"
+
+#ifdef WALLET_TRACE_ENABLED
+
+#include "wallet/wallet_log.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace Wallet {
+namespace details {
+namespace {
+
+constexpr auto kThreadBufferSpans = 1 << 16;
+
+struct Span {
+  const char *name = nullptr;
+  int64 start = 0;
+  int64 duration = 0;
+};
+
+// Written only by the owning thread, the exporter reads the first
+// `count` spans, which are published with a release store.
+struct ThreadBuffer {
+  explicit ThreadBuffer(int id) : id(id), spans(kThreadBufferSpans) {
+  }
+
+  const int id = 0;
+  std::vector<Span> spans;
+  std::atomic<int> count = 0;
+  std::atomic<int> dropped = 0;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry &Buffers() {
+  static auto result = Registry();
+  return result;
+}
+
+// Buffers live until the process exits, so spans of finished threads are still exported.
+ThreadBuffer &CurrentBuffer() {
+  thread_local const auto result = [] {
+    auto &registry = Buffers();
+    const auto lock = std::unique_lock(registry.mutex);
+    const auto id = int(registry.buffers.size()) + 1;
+    return registry.buffers.emplace_back(std::make_unique<ThreadBuffer>(id)).get();
+  }();
+  return *result;
+}
+
+int64 NowMicroseconds() {
+  using namespace std::chrono;
+  static const auto start = steady_clock::now();
+  return duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+void Record(const char *name, int64 start, int64 duration) {
+  auto &buffer = CurrentBuffer();
+  const auto index = buffer.count.load(std::memory_order_relaxed);
+  if (index == kThreadBufferSpans) {
+    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  buffer.spans[index] = Span{.name = name, .start = start, .duration = duration};
+  buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void AppendEscaped(QByteArray &result, const char *text) {
+  for (auto ch = text; *ch; ++ch) {
+    if (*ch == '"' || *ch == '\\') {
+      result.append('\\');
+    }
+    result.append(*ch);
+  }
+}
+
+QByteArray SerializeTrace() {
+  auto result = QByteArray("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  auto first = true;
+  auto &registry = Buffers();
+  const auto lock = std::unique_lock(registry.mutex);
+  for (const auto &buffer : registry.buffers) {
+    const auto count = buffer->count.load(std::memory_order_acquire);
+    for (auto i = 0; i != count; ++i) {
+      const auto &span = buffer->spans[i];
+      result.append(first ? "{\"name\":\"" : ",{\"name\":\"");
+      AppendEscaped(result, span.name);
+      result.append("\",\"cat\":\"wallet\",\"ph\":\"X\",\"pid\":1,\"tid\":")
+          .append(QByteArray::number(buffer->id))
+          .append(",\"ts\":")
+          .append(QByteArray::number(span.start))
+          .append(",\"dur\":")
+          .append(QByteArray::number(span.duration))
+          .append('}');
+      first = false;
+    }
+    if (const auto dropped = buffer->dropped.load(std::memory_order_relaxed)) {
+      WALLET_LOG(("Trace: thread %1 dropped %2 spans.").arg(buffer->id).arg(dropped));
+    }
+  }
+  result.append("]}");
+  return result;
+}
+
+}  // namespace
+
+TraceSpan::TraceSpan(const char *name) : _name(name), _start(NowMicroseconds()) {
+}
+
+TraceSpan::~TraceSpan() {
+  Record(_name, _start, NowMicroseconds() - _start);
+}
+
+}  // namespace details
+
+void FlushTrace() {
+  const auto custom = qEnvironmentVariable("WALLET_TRACE_FILE");
+  const auto path = custom.isEmpty() ? QDir::temp().filePath("wallet_trace.json") : custom;
+  auto file = QFile(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    WALLET_LOG(("Trace: could not write to '%1'.").arg(path));
+    return;
+  }
+  file.write(details::SerializeTrace());
+}
+
+}  // namespace Wallet
+
+#endif  // WALLET_TRACE_ENABLED
@@ -0,0 +1,63 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+// Scoped tracing spans, enabled by the WALLET_TRACE_ENABLED definition
+// (LIB_WALLET_TRACE cmake option). Without it all macros expand to nothing.
+//
+// WALLET_TRACE_SPAN("History::paint") records the time from this line
+// to the end of the enclosing scope. Span names must be string literals.
+//
+// Every thread records into its own fixed size buffer without locking,
+// FlushTrace() writes all recorded spans in Chrome trace JSON format
+// (chrome://tracing, ui.perfetto.dev) to the file set by the
+// WALLET_TRACE_FILE environment variable, or to wallet_trace.json
+// in the temporary folder.
+
+#ifdef WALLET_TRACE_ENABLED
+
+namespace Wallet::details {
+
+class TraceSpan final {
+ public:
+  explicit TraceSpan(const char *name);
+  TraceSpan(const TraceSpan &other) = delete;
+  TraceSpan &operator=(const TraceSpan &other) = delete;
+  ~TraceSpan();
+
+ private:
+  const char *_name = nullptr;
+  int64 _start = 0;
+};
+
+}  // namespace Wallet::details
+
+namespace Wallet {
+
+void FlushTrace();
+
+}  // namespace Wallet
+
+#define WALLET_TRACE_CONCAT_(a, b) a##b
+#define WALLET_TRACE_CONCAT(a, b) WALLET_TRACE_CONCAT_(a, b)
+#define WALLET_TRACE_SPAN(NAME) \
+  const auto WALLET_TRACE_CONCAT(walletTraceSpan, __LINE__) = ::Wallet::details::TraceSpan(NAME)
+
+#else  // WALLET_TRACE_ENABLED
+
+namespace Wallet {
+
+inline void FlushTrace() {
+}
+
+}  // namespace Wallet
+
+#define WALLET_TRACE_SPAN(NAME) \
+  do {                          \
+  } while (false)
+
+#endif  // WALLET_TRACE_ENABLED
@@ -0,0 +1,71 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "wallet/wallet_updates.h"
+
+namespace Wallet {
+namespace {
+
+constexpr auto kSyncProgressFrameDelay = crl::time(16);
+
+[[nodiscard]] SyncProgress ComputeSyncProgress(const Ton::SyncState &state) {
+  if (!state.valid() || state.current == state.to) {
+    return {};
+  } else if (state.current == state.from) {
+    return {.phase = SyncPhase::Started};
+  }
+  return {
+      .phase = SyncPhase::Progress,
+      .percent = int(100 * (state.current - state.from) / (state.to - state.from)),
+  };
+}
+
+}  // namespace
+
+UpdatesDispatcher::UpdatesDispatcher(rpl::producer<Ton::Update> updates)
+    : _syncProgressTimer([=] { publishSyncProgress(); }) {
+  std::move(updates)  //
+      | rpl::start_with_next(
+            [=](const Ton::Update &update) {
+              v::match(
+                  update.data,                                                                                //
+                  [&](const Ton::SyncState &data) { applySyncState(data); },                                  //
+                  [&](const Ton::DecryptPasswordNeeded &data) { _decryptPasswordNeeded.fire_copy(data); },  //
+                  [&](const Ton::DecryptPasswordGood &data) { _decryptPasswordGood.fire_copy(data); },      //
+                  [](auto &&) {});
+            },
+            _lifetime);
+}
+
+rpl::producer<SyncProgress> UpdatesDispatcher::syncProgress() const {
+  return rpl::single(_syncProgress) | rpl::then(_syncProgressChanges.events());
+}
+
+rpl::producer<Ton::DecryptPasswordNeeded> UpdatesDispatcher::decryptPasswordNeeded() const {
+  return _decryptPasswordNeeded.events();
+}
+
+rpl::producer<Ton::DecryptPasswordGood> UpdatesDispatcher::decryptPasswordGood() const {
+  return _decryptPasswordGood.events();
+}
+
+void UpdatesDispatcher::applySyncState(const Ton::SyncState &state) {
+  _syncProgressPending = ComputeSyncProgress(state);
+  if (!_syncProgressTimer.isActive()) {
+    publishSyncProgress();
+  }
+}
+
+void UpdatesDispatcher::publishSyncProgress() {
+  if (_syncProgressPending == _syncProgress) {
+    return;
+  }
+  _syncProgress = _syncProgressPending;
+  _syncProgressChanges.fire_copy(_syncProgress);
+  _syncProgressTimer.callOnce(kSyncProgressFrameDelay);
+}
+
+}  // namespace Wallet
@@ -0,0 +1,43 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+#include "ton/ton_state.h"
+#include "base/timer.h"
+
+#include "wallet_common.h"
+
+namespace Wallet {
+
+// Subscribes to Ton::Wallet::updates() once and splits them by type,
+// so that every consumer receives only the updates it is interested in.
+//
+// Sync states are reduced to the displayed phase and percent, changes
+// are published at most once per frame and the last one is never lost.
+class UpdatesDispatcher final {
+ public:
+  explicit UpdatesDispatcher(rpl::producer<Ton::Update> updates);
+
+  [[nodiscard]] rpl::producer<SyncProgress> syncProgress() const;
+  [[nodiscard]] rpl::producer<Ton::DecryptPasswordNeeded> decryptPasswordNeeded() const;
+  [[nodiscard]] rpl::producer<Ton::DecryptPasswordGood> decryptPasswordGood() const;
+
+ private:
+  void applySyncState(const Ton::SyncState &state);
+  void publishSyncProgress();
+
+  SyncProgress _syncProgress;
+  SyncProgress _syncProgressPending;
+  rpl::event_stream<SyncProgress> _syncProgressChanges;
+  base::Timer _syncProgressTimer;
+  rpl::event_stream<Ton::DecryptPasswordNeeded> _decryptPasswordNeeded;
+  rpl::event_stream<Ton::DecryptPasswordGood> _decryptPasswordGood;
+
+  rpl::lifetime _lifetime;
+};
+
+}  // namespace Wallet
@@ -102,6 +102,7 @@ std::optional<Notification> TryGetNotification(const Ton::Transaction &data) {
 }
 
 object_ptr<Ui::RpWidget> CreateSummary(not_null<Ui::RpWidget *> parent, const Ton::Transaction &data,
+                                       const TransactionSummary &summary,
                                        const std::optional<TokenTransaction> &tokenTransaction) {
   const auto isTokenTransaction = tokenTransaction.has_value();
   const auto token = isTokenTransaction ? tokenTransaction->token : Ton::Symbol::ton();
@@ -111,7 +112,7 @@ object_ptr<Ui::RpWidget> CreateSummary(not_null<Ui::RpWidget *> parent, const To
 
   const auto feeSkip = st::walletTransactionFeeSkip;
   const auto secondFeeSkip = st::walletTransactionSecondFeeSkip;
-  const auto service = IsServiceTransaction(data);
+  const auto service = summary.service;
   const auto height = st::walletTransactionSummaryHeight - (service ? st::walletTransactionValue.diamond : 0) +
                       (showTransactionFee ? (st::normalFont->height + feeSkip) : 0) +
                       (showStorageFee ? (st::normalFont->height + (showTransactionFee ? secondFeeSkip : feeSkip)) : 0);
@@ -121,7 +122,7 @@ object_ptr<Ui::RpWidget> CreateSummary(not_null<Ui::RpWidget *> parent, const To
                          ? tokenTransaction->incoming  //
                                ? tokenTransaction->amount
                                : -tokenTransaction->amount
-                         : CalculateValue(data);
+                         : summary.value;
   const auto balance =
       service  //
           ? nullptr
@@ -134,7 +135,7 @@ object_ptr<Ui::RpWidget> CreateSummary(not_null<Ui::RpWidget *> parent, const To
                 result.data(),
                 ph::lng_wallet_view_transaction_fee(ph::now).replace(
                     "{amount}",
-                    FormatAmount(isTokenTransaction ? CalculateValue(data) : data.otherFee, Ton::Symbol::ton()).full),
+                    FormatAmount(isTokenTransaction ? summary.value : data.otherFee, Ton::Symbol::ton()).full),
                 st::walletTransactionFee)
           : nullptr;
 
@@ -210,7 +211,8 @@ void SetupScrollByDrag(not_null<Ui::BoxContent *> box, not_null<Ui::RpWidget *>
 
 }  // namespace
 
-void ViewTransactionBox(not_null<Ui::GenericBox *> box, Ton::Transaction &&data, const Ton::Symbol &selectedToken,
+void ViewTransactionBox(not_null<Ui::GenericBox *> box, const TransactionPtr &transaction,
+                        const Ton::Symbol &selectedToken,
                         rpl::producer<not_null<std::vector<Ton::Transaction> *>> collectEncrypted,
                         rpl::producer<not_null<const std::vector<Ton::Transaction> *>> decrypted,
                         const Fn<void(QImage, QString)> &share, const Fn<void(const QString &)> &viewInExplorer,
@@ -223,6 +225,8 @@ void ViewTransactionBox(not_null<Ui::GenericBox *> box, Ton::Transaction &&data,
     bool success = false;
   };
 
+  const auto &data = *transaction;
+  const auto summary = SummarizeTransaction(data);
   auto tokenTransaction = selectedToken.isToken() ? TryGetTokenTransaction(data, selectedToken) : std::nullopt;
   auto notification = TryGetNotification(data);
   const auto isTokenTransaction = tokenTransaction.has_value();
@@ -244,7 +248,7 @@ void ViewTransactionBox(not_null<Ui::GenericBox *> box, Ton::Transaction &&data,
                                : Ton::Wallet::ConvertIntoRaw(tokenTransaction->recipient));
       }
     } else {
-      const auto address = ExtractAddress(data);
+      const auto &address = summary.counterparty;
       return rpl::single(address.isEmpty() ? address : Ton::Wallet::ConvertIntoRaw(address));
     }
   }();
@@ -256,7 +260,7 @@ void ViewTransactionBox(not_null<Ui::GenericBox *> box, Ton::Transaction &&data,
 
   const auto isSwapBack = isTokenTransaction && tokenTransaction->swapback;
 
-  const auto service = IsServiceTransaction(data);
+  const auto service = summary.service;
 
   /*data.initializing  //
     ? ph::lng_wallet_row_init()
@@ -267,8 +271,8 @@ void ViewTransactionBox(not_null<Ui::GenericBox *> box, Ton::Transaction &&data,
 
   const auto id = data.id;
   const auto incoming = data.outgoing.empty() || (isTokenTransaction && tokenTransaction->incoming);
-  const auto encryptedComment = IsEncryptedMessage(data);
-  const auto decryptedComment = encryptedComment ? QString() : ExtractMessage(data);
+  const auto encryptedComment = summary.encrypted;
+  const auto &decryptedComment = summary.message;
   const auto hasComment = encryptedComment || !decryptedComment.isEmpty();
   auto decryptedText = rpl::producer<DecryptedText>();
   auto complexComment = [&] {
@@ -279,8 +283,9 @@ void ViewTransactionBox(not_null<Ui::GenericBox *> box, Ton::Transaction &&data,
                       })                                                                                            //
                     | rpl::filter([=](const std::optional<Ton::Transaction> &value) { return value.has_value(); })  //
                     | rpl::map([=](const std::optional<Ton::Transaction> &value) {
-                        return IsEncryptedMessage(*value) ? DecryptedText{ph::lng_wallet_decrypt_failed(ph::now), false}
-                                                          : DecryptedText{ExtractMessage(*value), true};
+                        const auto updated = SummarizeTransaction(*value);
+                        return updated.encrypted ? DecryptedText{ph::lng_wallet_decrypt_failed(ph::now), false}
+                                                 : DecryptedText{updated.message, true};
                       })            //
                     | rpl::take(1)  //
                     | rpl::start_spawning(box->lifetime());
@@ -291,15 +296,15 @@ void ViewTransactionBox(not_null<Ui::GenericBox *> box, Ton::Transaction &&data,
                        | Ui::Text::ToWithEntities());
   };
 
-  auto message = IsEncryptedMessage(data)  //
+  auto message = encryptedComment  //
                      ? (complexComment() | rpl::type_erased())
-                     : rpl::single(Ui::Text::WithEntities(ExtractMessage(data)));
+                     : rpl::single(Ui::Text::WithEntities(decryptedComment));
 
   box->setStyle(service || emptyAddress ? st::walletNoButtonsBox : st::walletBox);
 
   box->addTopButton(st::boxTitleClose, [=] { box->closeBox(); });
 
-  box->addRow(CreateSummary(box, data, tokenTransaction));
+  box->addRow(CreateSummary(box, data, summary, tokenTransaction));
 
   if (!service && !emptyAddress && !currentAddress->current().isEmpty()) {
     AddBoxSubtitle(box, incoming ? ph::lng_wallet_view_sender() : ph::lng_wallet_view_recipient());
@@ -340,7 +345,7 @@ void ViewTransactionBox(not_null<Ui::GenericBox *> box, Ton::Transaction &&data,
   if (hasComment) {
     AddBoxSubtitle(box, ph::lng_wallet_view_comment());
     const auto comment = box->addRow(object_ptr<Ui::FlatLabel>(box, std::move(message), st::walletLabel));
-    if (IsEncryptedMessage(data)) {
+    if (encryptedComment) {
       std::move(decryptedText)                                                           //
           | rpl::map([=](const DecryptedText &decrypted) { return decrypted.success; })  //
           | rpl::start_with_next(
@@ -354,8 +359,9 @@ void ViewTransactionBox(not_null<Ui::GenericBox *> box, Ton::Transaction &&data,
 
       std::move(collectEncrypted)  //
           | rpl::take(1)           //
-          | rpl::start_with_next([=](not_null<std::vector<Ton::Transaction> *> list) { list->push_back(data); },
-                                 comment->lifetime());
+          | rpl::start_with_next(
+                [transaction](not_null<std::vector<Ton::Transaction> *> list) { list->push_back(*transaction); },
+                comment->lifetime());
 
       comment->setClickHandlerFilter([=](const auto &...) {
         decryptComment();
@@ -18,6 +18,7 @@
 #include "wallet/wallet_keystore.h"
 #include "wallet/wallet_send_grams.h"
 #include "wallet/wallet_send_stake.h"
+#include "wallet/wallet_batch_transfer.h"
 #include "wallet/wallet_depool_withdraw.h"
 #include "wallet/wallet_depool_cancel_withdrawal.h"
 #include "wallet/wallet_deploy_token_wallet.h"
@@ -30,13 +31,19 @@
 #include "wallet/wallet_export.h"
 #include "wallet/wallet_update_info.h"
 #include "wallet/wallet_settings.h"
+#include "wallet/wallet_refresh_scheduler.h"
+#include "wallet/wallet_fee_estimator.h"
+#include "wallet/wallet_contract_details.h"
+#include "wallet/wallet_updates.h"
+#include "wallet/wallet_trace.h"
 #include "wallet/create/wallet_create_manager.h"
 #include "ton/ton_wallet.h"
 #include "ton/ton_account_viewer.h"
 #include "base/platform/base_platform_process.h"
+#include "base/platform/base_platform_info.h"
 #include "base/qt_signal_producer.h"
-#include "base/last_user_input.h"
 #include "base/algorithm.h"
+#include "base/unixtime.h"
 #include "ui/widgets/window.h"
 #include "ui/widgets/labels.h"
 #include "ui/widgets/input_fields.h"
@@ -44,11 +51,14 @@
 #include "ui/layers/layer_manager.h"
 #include "ui/layers/generic_box.h"
 #include "ui/toast/toast.h"
+#include "ui/lottie_widget.h"
 #include "styles/style_layers.h"
 #include "styles/style_wallet.h"
 #include "styles/palette.h"
 
+#include <crl/crl_async.h>
 #include <QtCore/QMimeData>
+#include <QtCore/QBuffer>
 #include <QtCore/QDir>
 #include <QtCore/QRegularExpression>
 #include <QtGui/QtEvents>
@@ -58,13 +68,12 @@
 #include <QtGui/QDesktopServices>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QDesktopWidget>
+#include <QtWidgets/QFileDialog>
 
 namespace Wallet {
 namespace {
 
-constexpr auto kRefreshEachDelay = 10 * crl::time(1000);
-constexpr auto kRefreshInactiveDelay = 60 * crl::time(1000);
-constexpr auto kRefreshWhileSendingDelay = 3 * crl::time(1000);
+constexpr auto kRefreshFallbackDelay = 10 * 60 * crl::time(1000);
 
 [[nodiscard]] bool ValidateTransferLink(const QString &link) {
   return QRegularExpression(
@@ -74,13 +83,34 @@ constexpr auto kRefreshWhileSendingDelay = 3 * crl::time(1000);
       .hasMatch();
 }
 
+// Symbols and event roots belong to one blockchain, so each has its own file.
+[[nodiscard]] QString ContractDetailsPath(const QString &path, const Ton::Settings &settings) {
+  if (path.isEmpty()) {
+    return QString();
+  }
+  const auto name = QString::fromLatin1(settings.net().blockchainName.toUtf8().toHex());
+  return QDir(path).filePath((settings.useTestNetwork ? "contract_details_test_" : "contract_details_") + name);
+}
+
+void PrepareTokenTransfer(TokenTransferInvoice &invoice, const Ton::WalletState &state) {
+  const auto it = state.tokenStates.find(invoice.token);
+  if (it != state.tokenStates.end()) {
+    invoice.rootContractAddress = it->first.rootContractAddress();
+    invoice.walletContractAddress = it->second.walletContractAddress;
+  }
+  invoice.realAmount = Ton::TokenTransactionToSend::realAmount;
+}
+
 }  // namespace
 
-Window::Window(not_null<Ton::Wallet *> wallet, UpdateInfo *updateInfo)
+Window::Window(not_null<Ton::Wallet *> wallet, UpdateInfo *updateInfo, const QString &path)
     : _wallet(wallet)
+    , _updates(std::make_unique<UpdatesDispatcher>(_wallet->updates()))
+    , _feeEstimator(std::make_unique<FeeEstimator>(_wallet))
     , _window(std::make_unique<Ui::Window>())
     , _layers(std::make_unique<Ui::LayerManager>(_window->body()))
     , _updateInfo(updateInfo)
+    , _path(path)
     , _selectedAsset(std::nullopt) {
   init();
   const auto keys = _wallet->publicKeys();
@@ -91,9 +121,12 @@ Window::Window(not_null<Ton::Wallet *> wallet, UpdateInfo *updateInfo)
   }
 }
 
-Window::~Window() = default;
+Window::~Window() {
+  FlushTrace();
+}
 
 void Window::init() {
+  WALLET_TRACE_SPAN("Window::init");
   QApplication::setStartDragDistance(32);
 
   _window->setTitle(QString());
@@ -105,10 +138,12 @@ void Window::init() {
   updatePalette();
   style::PaletteChanged() | rpl::start_with_next([=] { updatePalette(); }, _window->lifetime());
 
+  setupAnimationsMode();
   startWallet();
 }
 
 void Window::startWallet() {
+  WALLET_TRACE_SPAN("Window::startWallet");
   const auto &was = _wallet->settings().net();
 
   if (was.useCustomConfig) {
@@ -143,6 +178,7 @@ void Window::showCreate() {
   _layers->hideAll();
   _info = nullptr;
   _viewer = nullptr;
+  _contractDetails = nullptr;
   _updateButton.destroy();
 
   _window->setTitleStyle(st::defaultWindowTitle);
@@ -320,22 +356,15 @@ void Window::createSavePasscode(const QByteArray &passcode, const std::shared_pt
     return createSaveKey(passcode, QString(), guard);
   }
 
-  rpl::single(Ton::Update{Ton::SyncState()})  //
-      | rpl::then(_wallet->updates())         //
-      | rpl::map([](const Ton::Update &update) {
-          return v::match(
-              update.data,
-              [&](const Ton::SyncState &data) {
-                if (!data.valid() || data.current == data.to || data.current == data.from) {
-                  return ph::lng_wallet_sync();
-                } else {
-                  const auto percent = QString::number((100 * (data.current - data.from) / (data.to - data.from)));
-                  return ph::lng_wallet_sync_percent() |
-                         rpl::map([=](QString &&text) { return text.replace("{percent}", percent); }) |
-                         rpl::type_erased();
-                }
-              },
-              [&](auto &&) { return ph::lng_wallet_sync(); });
+  _updates->syncProgress()  //
+      | rpl::map([](const SyncProgress &progress) {
+          if (progress.phase != SyncPhase::Progress) {
+            return ph::lng_wallet_sync();
+          } else {
+            const auto percent = QString::number(progress.percent);
+            return ph::lng_wallet_sync_percent() |
+                   rpl::map([=](QString &&text) { return text.replace("{percent}", percent); }) | rpl::type_erased();
+          }
         })                     //
       | rpl::flatten_latest()  //
       | rpl::start_to_stream(_createSyncing, _createManager->lifetime());
@@ -364,6 +393,7 @@ void Window::createSaveKey(const QByteArray &passcode, const QString &address, c
 }
 
 void Window::showAccount(const QByteArray &publicKey, bool justCreated) {
+  WALLET_TRACE_SPAN("Window::showAccount");
   _layers->hideAll();
   _importing = false;
   _createManager = nullptr;
@@ -371,20 +401,17 @@ void Window::showAccount(const QByteArray &publicKey, bool justCreated) {
   _packedAddress = _wallet->getUsedAddress(publicKey);
   _rawAddress = Ton::Wallet::ConvertIntoRaw(_packedAddress);
   _viewer = _wallet->createAccountViewer(publicKey, _packedAddress);
+  _contractDetails = std::make_unique<ContractDetails>(_wallet, ContractDetailsPath(_path, _wallet->settings()));
   _state = _viewer->state() | rpl::map([](Ton::WalletViewerState &&state) { return std::move(state.wallet); });
   _syncing = false;
-  _syncing = _wallet->updates()  //
-             | rpl::map([](const Ton::Update &update) {
-                 return v::match(
-                     update.data, [&](const Ton::SyncState &data) { return data.valid() && (data.current != data.to); },
-                     [&](auto &&) { return false; });
-               });
+  _syncing = _updates->syncProgress()  //
+             | rpl::map([](const SyncProgress &progress) { return progress.syncing(); });
 
   _window->setTitleStyle(st::walletWindowTitle);
   Info::Data data{
       .state = _viewer->state(),
       .loaded = _viewer->loaded(),
-      .updates = _wallet->updates(),
+      .syncProgress = _updates->syncProgress(),
       .collectEncrypted = _collectEncryptedRequests.events(),
       .updateDecrypted = _decrypted.events(),
       .updateWalletOwners = _updateTokenOwners.events(),
@@ -478,6 +505,16 @@ void Window::showAccount(const QByteArray &publicKey, bool justCreated) {
                   return showSettings();
                 case Action::ShowKeystore:
                   return showKeystore();
+                case Action::BatchTransfer:
+                  return batchTransfer();
+                case Action::ConfirmMultisig:
+                  v::match(
+                      _selectedAsset.current().value_or(SelectedToken::defaultToken()),
+                      [&](const SelectedMultisig &selectedMultisig) {
+                        confirmMultisigTransactions(selectedMultisig.address);
+                      },
+                      [](auto &&) {});
+                  return;
                 case Action::AddAsset:
                   return addAsset();
                 case Action::Deploy:
@@ -599,9 +636,9 @@ void Window::showAccount(const QByteArray &publicKey, bool justCreated) {
                   }));
             };
 
-            auto gotDetails = [=, transaction = *transaction](auto details) mutable {
-              if (details.has_value() && !details->rootTokenContract.isEmpty()) {
-                const auto &rootTokenContract = details->rootTokenContract;
+            auto gotRootTokenContract = [=, transaction = *transaction](Ton::Result<QString> result) mutable {
+              if (result.has_value() && !result->isEmpty()) {
+                const auto rootTokenContract = *result;
 
                 const auto state = _state.current();
                 for (const auto &item : state.tokenStates) {
@@ -613,13 +650,13 @@ void Window::showAccount(const QByteArray &publicKey, bool justCreated) {
                   }
                 }
 
-                _wallet->getRootTokenContractDetails(
-                    rootTokenContract,
-                    crl::guard(this, [=](const Ton::Result<Ton::RootTokenContractDetails> &details) mutable {
-                      const auto symbol = Ton::Symbol::tip3(details->symbol, details->decimals, rootTokenContract);
-
+                _contractDetails->rootTokenSymbol(
+                    rootTokenContract, crl::guard(this, [=](Ton::Result<Ton::Symbol> symbol) mutable {
+                      if (!symbol.has_value()) {
+                        return;
+                      }
                       _notificationHistoryUpdates.fire(AddNotification{
-                          .symbol = symbol,
+                          .symbol = *symbol,
                           .transaction = std::move(transaction),
                       });
 
@@ -631,10 +668,12 @@ void Window::showAccount(const QByteArray &publicKey, bool justCreated) {
                 transaction->additional,
                 [&](const Ton::TokenWalletDeployed &event) { addToken(event.rootTokenContract); },
                 [&](const Ton::EthEventStatusChanged &) {
-                  _wallet->getEthEventDetails(transaction->incoming.source, crl::guard(this, gotDetails));
+                  _contractDetails->eventRootTokenContract(transaction->incoming.source, EventKind::Eth,
+                                                           crl::guard(this, gotRootTokenContract));
                 },
                 [&](const Ton::TonEventStatusChanged &) {
-                  _wallet->getTonEventDetails(transaction->incoming.source, crl::guard(this, gotDetails));
+                  _contractDetails->eventRootTokenContract(transaction->incoming.source, EventKind::Ton,
+                                                           crl::guard(this, gotRootTokenContract));
                 },
                 [](auto &&) {});
           },
@@ -681,7 +720,7 @@ void Window::showAccount(const QByteArray &publicKey, bool justCreated) {
 
   _info->viewRequests() |
       rpl::start_with_next(
-          [=](Ton::Transaction &&data) {
+          [=](const TransactionPtr &data) {
             const auto selectedAsset = _selectedAsset.current().value_or(SelectedToken::defaultToken());
 
             v::match(
@@ -716,17 +755,17 @@ void Window::showAccount(const QByteArray &publicKey, bool justCreated) {
                       this, [=](const QString &eventAddress) { _wallet->openGateExecuteSwapBack(eventAddress); });
 
                   _layers->showBox(Box(
-                      ViewTransactionBox, std::move(data), selectedToken.symbol, _collectEncryptedRequests.events(),
+                      ViewTransactionBox, data, selectedToken.symbol, _collectEncryptedRequests.events(),
                       _decrypted.events(), shareAddressCallback(),
                       [=](const QString &transactionHash) { openInExplorer(transactionHash); },
                       [=] { decryptEverything(publicKey); }, resolveOwner, send, collect, execute));
                 },
                 [&](const SelectedDePool &selectedDePool) {
-                  _layers->showBox(Box(ViewDePoolTransactionBox, std::move(data), shareAddressCallback()));
+                  _layers->showBox(Box(ViewDePoolTransactionBox, *data, shareAddressCallback()));
                 },
                 [&](const SelectedMultisig &selectedMultisig) {
                   _layers->showBox(Box(
-                      ViewTransactionBox, std::move(data), Ton::Symbol::ton(), _collectEncryptedRequests.events(),
+                      ViewTransactionBox, data, Ton::Symbol::ton(), _collectEncryptedRequests.events(),
                       _decrypted.events(), shareAddressCallback(),
                       [=](const QString &transactionHash) { openInExplorer(transactionHash); },
                       [=] { decryptEverything(publicKey); },
@@ -743,26 +782,24 @@ void Window::showAccount(const QByteArray &publicKey, bool justCreated) {
 
   _info->decryptRequests() | rpl::start_with_next([=] { decryptEverything(publicKey); }, _info->lifetime());
 
-  _wallet->updates()                                                                                           //
-      | rpl::filter([](const Ton::Update &update) { return v::is<Ton::DecryptPasswordNeeded>(update.data); })  //
-      | rpl::start_with_next(
-            [=](const Ton::Update &update) { askDecryptPassword(v::get<Ton::DecryptPasswordNeeded>(update.data)); },
-            _info->lifetime());
+  _updates->decryptPasswordNeeded()  //
+      | rpl::start_with_next([=](const Ton::DecryptPasswordNeeded &data) { askDecryptPassword(data); },
+                             _info->lifetime());
 
-  _wallet->updates()                                                                                         //
-      | rpl::filter([](const Ton::Update &update) { return v::is<Ton::DecryptPasswordGood>(update.data); })  //
-      | rpl::start_with_next(
-            [=](const Ton::Update &update) { doneDecryptPassword(v::get<Ton::DecryptPasswordGood>(update.data)); },
-            _info->lifetime());
+  _updates->decryptPasswordGood()  //
+      | rpl::start_with_next([=](const Ton::DecryptPasswordGood &data) { doneDecryptPassword(data); },
+                             _info->lifetime());
 }
 
 void Window::decryptEverything(const QByteArray &publicKey) {
+  WALLET_TRACE_SPAN("Window::decryptEverything");
   auto transactions = std::vector<Ton::Transaction>();
   _collectEncryptedRequests.fire(&transactions);
   if (transactions.empty()) {
     return;
   }
   const auto done = [=](const Ton::Result<std::vector<Ton::Transaction>> &result) {
+    WALLET_TRACE_SPAN("Window::applyDecrypted");
     if (!result) {
       showGenericError(result.error());
       return;
@@ -859,36 +896,38 @@ void Window::setupRefreshEach() {
   Expects(_viewer != nullptr);
   Expects(_info != nullptr);
 
-  const auto basedOnActivity =
-      _viewer->state()  //
-      | rpl::map([] {
-          return (base::SinceLastUserInput() > kRefreshEachDelay) ? kRefreshInactiveDelay : kRefreshEachDelay;
-        });
+  // The scheduler requests refreshes itself, the viewer timer is only a fallback.
+  _viewer->setRefreshEach(kRefreshFallbackDelay);
 
-  const auto basedOnWindowActive =
-      rpl::single(rpl::empty_value()) |
-      rpl::then(base::qt_signal_producer(_window->windowHandle(), &QWindow::activeChanged)) |
-      rpl::map([=]() -> rpl::producer<crl::time> {
-        if (!_window->isActiveWindow()) {
-          return rpl::single(kRefreshInactiveDelay);
-        }
-        return rpl::duplicate(basedOnActivity);
-      }) |
-      rpl::flatten_latest();
-
-  const auto basedOnPending =
-      _viewer->state()                                                                                            //
-      | rpl::map([=](const Ton::WalletViewerState &state) { return !state.wallet.pendingTransactions.empty(); })  //
-      | rpl::distinct_until_changed() | rpl::map([=](bool hasPending) -> rpl::producer<crl::time> {
-          if (hasPending) {
-            return rpl::single(kRefreshWhileSendingDelay);
-          }
-          return rpl::duplicate(basedOnWindowActive);
-        })  //
-      | rpl::flatten_latest();
+  const auto scheduler = _info->lifetime().make_state<RefreshScheduler>([=](Fn<void(bool)> done) {
+    _viewer->refreshNow([=](Ton::Result<> result) { done(bool(result)); });
+  });
+
+  _viewer->state()  //
+      | rpl::start_with_next([=](const Ton::WalletViewerState &state) { scheduler->setState(state); },
+                             _info->lifetime());
+
+  rpl::single(rpl::empty_value())                                                              //
+      | rpl::then(base::qt_signal_producer(_window->windowHandle(), &QWindow::activeChanged))  //
+      | rpl::start_with_next([=] { scheduler->setForeground(_window->isActiveWindow()); }, _info->lifetime());
+}
+
+void Window::setupAnimationsMode() {
+  const auto computeMode = [=] {
+    if (_window->isHidden() || _window->isMinimized()) {
+      return Ui::AnimationsMode::Paused;
+    }
+    return _window->isActiveWindow() ? Ui::AnimationsMode::Normal : Ui::AnimationsMode::Throttled;
+  };
 
-  rpl::duplicate(basedOnPending) | rpl::distinct_until_changed() |
-      rpl::start_with_next([=](crl::time delay) { _viewer->setRefreshEach(delay); }, _info->lifetime());
+  _window->events()  //
+      | rpl::filter([](not_null<QEvent *> e) {
+          const auto type = e->type();
+          return (type == QEvent::ActivationChange) || (type == QEvent::WindowStateChange) ||
+                 (type == QEvent::Show) || (type == QEvent::Hide);
+        })                                                        //
+      | rpl::map([=] { return computeMode(); })                   //
+      | rpl::start_with_next([](Ui::AnimationsMode mode) { Ui::SetAnimationsMode(mode); }, _window->lifetime());
 }
 
 void Window::showAndActivate() {
@@ -971,32 +1010,55 @@ void Window::sendMoney(const PreparedInvoiceOrLink &invoice) {
   auto box = v::match(
       parsedInvoice,
       [=](const TonTransferInvoice &tonTransferInvoice) {
-        const auto send = [=](const TonTransferInvoice &finalInvoice, const Fn<void(InvoiceField)> &showError) {
+        const auto invalid = [=](const TonTransferInvoice &finalInvoice) -> std::optional<InvoiceField> {
           if (!Ton::Wallet::CheckAddress(finalInvoice.address)) {
-            showError(InvoiceField::Address);
+            return InvoiceField::Address;
           } else if (finalInvoice.amount > available(defaultToken) || finalInvoice.amount <= 0) {
-            showError(InvoiceField::Amount);
+            return InvoiceField::Amount;
+          }
+          return std::nullopt;
+        };
+        const auto send = [=](const TonTransferInvoice &finalInvoice, const Fn<void(InvoiceField)> &showError) {
+          if (const auto field = invalid(finalInvoice)) {
+            showError(*field);
           } else {
             confirmTransaction(finalInvoice, showError, checking);
           }
         };
+        const auto estimate = [=](const TonTransferInvoice &finalInvoice) {
+          if (!invalid(finalInvoice)) {
+            _feeEstimator->estimate(getMainPublicKey(), finalInvoice);
+          }
+        };
 
-        return Box(SendGramsBox<TonTransferInvoice>, tonTransferInvoice, _state.value(), send);
+        return Box(SendGramsBox<TonTransferInvoice>, tonTransferInvoice, _state.value(), send, estimate);
       },
       [=](TokenTransferInvoice &tokenTransferInvoice) {
-        const auto send = [=](const TokenTransferInvoice &finalInvoice, const Fn<void(InvoiceField)> &showError) {
+        const auto invalid = [=](const TokenTransferInvoice &finalInvoice) -> std::optional<InvoiceField> {
           if (finalInvoice.transferType != Ton::TokenTransferType::SwapBack &&
               !Ton::Wallet::CheckAddress(finalInvoice.address)) {
-            showError(InvoiceField::Address);
+            return InvoiceField::Address;
           } else if (finalInvoice.amount > available(finalInvoice.token) || finalInvoice.amount <= 0) {
-            showError(InvoiceField::Amount);
+            return InvoiceField::Amount;
           } else if (finalInvoice.transferType == Ton::TokenTransferType::SwapBack &&
                      !Ton::Wallet::CheckAddress(finalInvoice.callbackAddress)) {
-            showError(InvoiceField::CallbackAddress);
+            return InvoiceField::CallbackAddress;
+          }
+          return std::nullopt;
+        };
+        const auto send = [=](const TokenTransferInvoice &finalInvoice, const Fn<void(InvoiceField)> &showError) {
+          if (const auto field = invalid(finalInvoice)) {
+            showError(*field);
           } else {
             confirmTransaction(finalInvoice, showError, checking);
           }
         };
+        const auto estimate = [=](TokenTransferInvoice finalInvoice) {
+          if (!invalid(finalInvoice)) {
+            PrepareTokenTransfer(finalInvoice, _state.current());
+            _feeEstimator->estimate(getMainPublicKey(), finalInvoice);
+          }
+        };
 
         if (tokenTransferInvoice.callbackAddress.isEmpty()) {
           const auto state = _state.current();
@@ -1006,7 +1068,7 @@ void Window::sendMoney(const PreparedInvoiceOrLink &invoice) {
           }
         }
 
-        return Box(SendGramsBox<TokenTransferInvoice>, tokenTransferInvoice, _state.value(), send);
+        return Box(SendGramsBox<TokenTransferInvoice>, tokenTransferInvoice, _state.value(), send, estimate);
       },
       [=](MultisigSubmitTransactionInvoice &invoice) {
         const auto send = [=](const MultisigSubmitTransactionInvoice &invoice,
@@ -1025,7 +1087,7 @@ void Window::sendMoney(const PreparedInvoiceOrLink &invoice) {
           confirmTransaction(invoice, showError, checking);
         };
 
-        return Box(SendGramsBox<MultisigSubmitTransactionInvoice>, invoice, _state.value(), send);
+        return Box(SendGramsBox<MultisigSubmitTransactionInvoice>, invoice, _state.value(), send, nullptr);
       },
       [=](auto &&) -> object_ptr<Ui::GenericBox> { return nullptr; });
 
@@ -1035,6 +1097,341 @@ void Window::sendMoney(const PreparedInvoiceOrLink &invoice) {
   }
 }
 
+void Window::batchTransfer() {
+  if (_batchTransferBox) {
+    _batchTransferBox->closeBox();
+  }
+  if (!_state.current().pendingTransactions.empty()) {
+    showSimpleError(ph::lng_wallet_warning(), ph::lng_wallet_wait_pending(), ph::lng_wallet_ok());
+    return;
+  } else if (_syncing.current()) {
+    showSimpleError(ph::lng_wallet_warning(), ph::lng_wallet_wait_syncing(), ph::lng_wallet_ok());
+    return;
+  }
+
+  const auto selected = _selectedAsset.current().value_or(SelectedToken::defaultToken());
+  if (!v::is<SelectedToken>(selected)) {
+    return;
+  }
+  const auto symbol = v::get<SelectedToken>(selected).symbol;
+
+  const auto all = Platform::IsWindows() ? "(*.*)" : "(*)";
+  const auto filter = QString("CSV Files (*.csv);;All Files ") + all;
+  const auto path = QFileDialog::getOpenFileName(_window.get(), QString(), QString(), filter);
+  if (path.isEmpty()) {
+    return;
+  }
+  auto file = QFile(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    showSimpleError(ph::lng_wallet_batch_transfer_title(), ph::lng_wallet_batch_transfer_read_error(),
+                    ph::lng_wallet_ok());
+    return;
+  }
+  auto rows = ParseBatchTransfer(file.readAll(), symbol);
+  if (rows.empty()) {
+    showSimpleError(ph::lng_wallet_batch_transfer_title(), ph::lng_wallet_batch_transfer_empty(), ph::lng_wallet_ok());
+    return;
+  }
+
+  auto rootContractAddress = QString();
+  auto walletContractAddress = QString();
+  if (symbol.isToken()) {
+    const auto state = _state.current();
+    const auto it = state.tokenStates.find(symbol);
+    if (it != state.tokenStates.end()) {
+      rootContractAddress = it->first.rootContractAddress();
+      walletContractAddress = it->second.walletContractAddress;
+    }
+  }
+
+  const auto mainPublicKey = getMainPublicKey();
+  const auto check = [=](int index, Fn<void(BatchTransferChecked)> done) {
+    const auto &row = rows[index];
+    if (symbol.isTon()) {
+      const auto invoice = TonTransferInvoice{
+          .amount = static_cast<int64>(row.amount),
+          .address = row.address,
+          .comment = row.comment,
+      };
+      _wallet->checkSendGrams(mainPublicKey, invoice.asTransaction(),
+                              crl::guard(this, [=](Ton::Result<Ton::TransactionCheckResult> result) {
+                                if (!result) {
+                                  return done({.error = result.error().details});
+                                }
+                                done({.invoice = invoice, .fee = result->sourceFees.sum()});
+                              }));
+      return;
+    }
+
+    auto invoice = TokenTransferInvoice{
+        .token = symbol,
+        .amount = row.amount,
+        .realAmount = Ton::TokenTransactionToSend::realAmount,
+        .rootContractAddress = rootContractAddress,
+        .walletContractAddress = walletContractAddress,
+        .address = row.address,
+    };
+    const auto handler = [=](Ton::Result<std::pair<Ton::TransactionCheckResult, Ton::TokenTransferCheckResult>>
+                                 result) mutable {
+      if (!result) {
+        return done({.error = result.error().details});
+      }
+      const auto fee = invoice.realAmount + result->first.sourceFees.sum();
+      v::match(
+          result->second,
+          [&](const Ton::InvalidEthAddress &) {
+            done({.error = ph::lng_wallet_batch_transfer_invalid_address(ph::now)});
+          },
+          [&](const Ton::TokenTransferUnchanged &) { done({.invoice = invoice, .fee = fee}); },
+          [&](const Ton::DirectAccountNotFound &) {
+            done({.error = ph::lng_wallet_batch_transfer_recipient_not_found(ph::now)});
+          },
+          [&](const Ton::DirectRecipient &directRecipient) {
+            invoice.transferType = Ton::TokenTransferType::Direct;
+            invoice.address = directRecipient.address;
+            done({.invoice = invoice, .fee = fee});
+          });
+    };
+    _wallet->checkSendTokens(mainPublicKey, invoice.asTransaction(), crl::guard(this, handler));
+  };
+
+  auto funds = _state.value() | rpl::map([=](const Ton::WalletState &state) {
+    const auto ton = state.account.fullBalance - state.account.lockedBalance;
+    auto result = BatchTransferFunds{.asset = ton, .ton = ton};
+    if (symbol.isToken()) {
+      const auto it = state.tokenStates.find(symbol);
+      result.asset = (it != state.tokenStates.end()) ? it->second.balance : int128();
+    }
+    return result;
+  });
+
+  const auto transfer = std::make_shared<BatchTransfer>(std::move(rows), symbol, check);
+  const auto weak = base::make_weak(transfer.get());
+  auto box = Box(BatchTransferBox, BatchTransferKind::Transfer, symbol, transfer, std::move(funds), [=] {
+    if (const auto strong = weak.get()) {
+      askBatchTransferPassword(strong, mainPublicKey);
+    }
+  });
+  _batchTransferBox = box.data();
+  _layers->showBox(std::move(box));
+}
+
+void Window::confirmMultisigTransactions(const QString &address) {
+  if (_batchTransferBox) {
+    _batchTransferBox->closeBox();
+  }
+
+  const auto state = _state.current();
+  const auto it = state.multisigStates.find(address);
+  if (it == state.multisigStates.end()) {
+    return;
+  }
+  const auto &multisig = it->second;
+
+  auto executed = base::flat_set<int64>();
+  for (const auto &transaction : multisig.lastTransactions.list) {
+    v::match(
+        transaction.additional,
+        [&](const Ton::MultisigConfirmTransaction &confirmTransaction) {
+          if (confirmTransaction.executed) {
+            executed.emplace(confirmTransaction.transactionId);
+          }
+        },
+        [](auto &&) {});
+  }
+
+  const auto now = base::unixtime::now();
+  auto rows = std::vector<BatchTransferRow>();
+  auto invoices = std::vector<MultisigConfirmTransactionInvoice>();
+  for (const auto &transaction : multisig.lastTransactions.list) {
+    v::match(
+        transaction.additional,
+        [&](const Ton::MultisigSubmitTransaction &submitTransaction) {
+          if (submitTransaction.executed || !submitTransaction.transactionId ||
+              executed.contains(submitTransaction.transactionId) ||
+              (transaction.time + multisig.expirationTime) < now) {
+            return;
+          }
+          rows.push_back(BatchTransferRow{
+              .line = int(rows.size()) + 1,
+              .address = submitTransaction.dest,
+              .amount = submitTransaction.amount,
+              .comment = submitTransaction.comment,
+          });
+          invoices.push_back(MultisigConfirmTransactionInvoice{
+              .multisigAddress = address,
+              .transactionId = submitTransaction.transactionId,
+          });
+        },
+        [](auto &&) {});
+  }
+  if (rows.empty()) {
+    showSimpleError(ph::lng_wallet_multisig_confirm_batch_title(), ph::lng_wallet_multisig_confirm_batch_empty(),
+                    ph::lng_wallet_ok());
+    return;
+  }
+
+  // One key is chosen for the whole batch, it signs every confirmation.
+  const auto keySelected = std::make_shared<bool>(false);
+  selectMultisigKey(multisig.custodians, 0, false, [=](const QByteArray &publicKey) {
+    if (std::exchange(*keySelected, true)) {
+      return;
+    }
+    if (_keySelectionBox) {
+      _keySelectionBox->closeBox();
+    }
+
+    const auto check = [=](int index, Fn<void(BatchTransferChecked)> done) {
+      auto invoice = invoices[index];
+      invoice.publicKey = publicKey;
+      _wallet->checkConfirmTransaction(invoice.asTransaction(),
+                                       crl::guard(this, [=](Ton::Result<Ton::TransactionCheckResult> result) {
+                                         if (!result) {
+                                           return done({.error = result.error().details});
+                                         }
+                                         done({.invoice = invoice, .fee = result->sourceFees.sum()});
+                                       }));
+    };
+
+    const auto transfer = std::make_shared<BatchTransfer>(rows, Ton::Symbol::ton(), check);
+    const auto weak = base::make_weak(transfer.get());
+    auto box = Box(BatchTransferBox, BatchTransferKind::MultisigConfirmation, Ton::Symbol::ton(), transfer,
+                   rpl::never<BatchTransferFunds>(), [=] {
+      if (const auto strong = weak.get()) {
+        askBatchTransferPassword(strong, publicKey);
+      }
+    });
+    _batchTransferBox = box.data();
+    _layers->showBox(std::move(box));
+  });
+}
+
+void Window::askBatchTransferPassword(not_null<BatchTransfer *> transfer, const QByteArray &publicKey) {
+  const auto mainPublicKey = getMainPublicKey();
+  auto existingKeys = getExistingKeys();
+  const auto it = existingKeys.find(publicKey);
+  if (it == existingKeys.end()) {
+    return showKeyNotFound();
+  }
+
+  const auto weak = base::make_weak(transfer.get());
+  const auto submit = [=](const QByteArray &passcode, Fn<void(QString)> showError) {
+    const auto strong = weak.get();
+    if (!strong) {
+      return;
+    }
+    // The password is checked by the first send, the rest reuse it.
+    const auto unlocked = std::make_shared<bool>();
+    strong->send([=](const PreparedInvoice &invoice, Fn<void()> accepted, Fn<void(std::optional<QString>)> done) {
+      // Multisig confirmations are signed by a custodian key and don't
+      // wait for each other, main wallet transfers go one at a time.
+      const auto multisigAddress = v::match(
+          invoice, [](const MultisigConfirmTransactionInvoice &invoice) { return invoice.multisigAddress; },
+          [](auto &&) { return QString(); });
+      const auto finished = std::make_shared<bool>();
+      const auto finish = [=](std::optional<QString> error) {
+        if (!std::exchange(*finished, true)) {
+          done(std::move(error));
+        }
+      };
+      const auto ready = [=](Ton::Result<Ton::PendingTransaction> result) {
+        if (!result) {
+          if (!*unlocked && IsIncorrectPasswordError(result.error())) {
+            if (const auto strong = weak.get()) {
+              strong->interrupt();
+            }
+            if (_sendConfirmBox) {
+              showError(ph::lng_wallet_passcode_incorrect(ph::now));
+            }
+            return;
+          }
+          return finish(result.error().details);
+        }
+        if (!std::exchange(*unlocked, true)) {
+          if (_sendConfirmBox) {
+            _sendConfirmBox->closeBox();
+          }
+          if (multisigAddress.isEmpty()) {
+            _wallet->updateViewersPassword(mainPublicKey, passcode);
+            decryptEverything(mainPublicKey);
+          }
+        }
+        const auto strong = weak.get();
+        if (!strong) {
+          return;
+        }
+        const auto transaction = *result;
+        // Multisig pending transactions appear in the state only after the
+        // message is sent, while confirmations are pipelined and other
+        // state updates can come first. So their absence means a failure
+        // only after they were seen pending at least once.
+        const auto seenPending = std::make_shared<bool>(multisigAddress.isEmpty());
+        const auto findResult = [=](const std::vector<Ton::PendingTransaction> &pending,
+                                    const Ton::TransactionsSlice &last) -> std::optional<bool> {
+          if (ranges::find(last.list, transaction.fake) != end(last.list)) {
+            return true;
+          } else if (ranges::find(pending, transaction) != end(pending)) {
+            *seenPending = true;
+            return std::nullopt;
+          } else if (!*seenPending) {
+            return std::nullopt;
+          }
+          return false;
+        };
+        _state.value()  //
+            | rpl::map([=](const Ton::WalletState &state) -> std::optional<bool> {
+                if (multisigAddress.isEmpty()) {
+                  return findResult(state.pendingTransactions, state.lastTransactions);
+                }
+                const auto i = state.multisigStates.find(multisigAddress);
+                if (i == state.multisigStates.end()) {
+                  return false;
+                }
+                return findResult(i->second.pendingTransactions, i->second.lastTransactions);
+              })                      //
+            | rpl::filter_optional()  //
+            | rpl::take(1)            //
+            | rpl::start_with_next(
+                  [=](bool found) {
+                    finish(found ? std::nullopt : std::make_optional(ph::lng_wallet_send_failed_title(ph::now)));
+                  },
+                  strong->lifetime());
+        if (!multisigAddress.isEmpty()) {
+          accepted();
+        }
+      };
+      const auto sent = [=](Ton::Result<> result) {
+        if (!result) {
+          finish(result.error().details);
+        }
+      };
+
+      v::match(
+          invoice,
+          [&](const TonTransferInvoice &tonTransferInvoice) {
+            _wallet->sendGrams(mainPublicKey, passcode, tonTransferInvoice.asTransaction(), crl::guard(this, ready),
+                               crl::guard(this, sent));
+          },
+          [&](const TokenTransferInvoice &tokenTransferInvoice) {
+            _wallet->sendTokens(mainPublicKey, passcode, tokenTransferInvoice.asTransaction(),
+                                crl::guard(this, ready), crl::guard(this, sent));
+          },
+          [&](const MultisigConfirmTransactionInvoice &confirmInvoice) {
+            _wallet->confirmTransaction(mainPublicKey, passcode, confirmInvoice.asTransaction(),
+                                        crl::guard(this, ready), crl::guard(this, sent));
+          },
+          [](auto &&) { Unexpected("Invoice in Window::askBatchTransferPassword."); });
+    });
+  };
+
+  if (_sendConfirmBox) {
+    _sendConfirmBox->closeBox();
+  }
+  auto box = Box(EnterPasscodeBox, it->second.name, submit);
+  _sendConfirmBox = box.data();
+  _layers->showBox(std::move(box));
+}
+
 void Window::sendStake(const StakeInvoice &invoice) {
   if (_sendBox) {
     _sendBox->closeBox();
@@ -1146,7 +1543,7 @@ void Window::collectTokens(const QString &eventContractAddress) {
   auto ethEventDetails = std::make_shared<rpl::event_stream<Ton::Result<Ton::EthEventDetails>>>();
   auto symbolEvents = std::make_shared<rpl::event_stream<Ton::Symbol>>();
 
-  _wallet->getEthEventDetails(  //
+  _contractDetails->ethEventDetails(  //
       eventContractAddress, crl::guard(this, [=](Ton::Result<Ton::EthEventDetails> details) {
         if (details.has_value() && !details->rootTokenContract.isEmpty()) {
           const auto &rootTokenContract = details->rootTokenContract;
@@ -1160,10 +1557,10 @@ void Window::collectTokens(const QString &eventContractAddress) {
             }
           }
           if (!found) {
-            _wallet->getRootTokenContractDetails(
-                rootTokenContract, crl::guard(this, [=](Ton::Result<Ton::RootTokenContractDetails> details) {
-                  if (details.has_value()) {
-                    symbolEvents->fire(Ton::Symbol::tip3(details->symbol, details->decimals, rootTokenContract));
+            _contractDetails->rootTokenSymbol(
+                rootTokenContract, crl::guard(this, [=](Ton::Result<Ton::Symbol> symbol) {
+                  if (symbol.has_value()) {
+                    symbolEvents->fire(std::move(*symbol));
                   }
                 }));
           }
@@ -1179,6 +1576,7 @@ void Window::collectTokens(const QString &eventContractAddress) {
 
 void Window::confirmTransaction(PreparedInvoice invoice, const Fn<void(InvoiceField)> &showInvoiceError,
                                 const std::shared_ptr<bool> &guard) {
+  WALLET_TRACE_SPAN("Window::confirmTransaction");
   if (*guard) {
     return;
   }
@@ -1196,15 +1594,7 @@ void Window::confirmTransaction(PreparedInvoice invoice, const Fn<void(InvoiceFi
       [&](TonTransferInvoice &tonTransferInvoice) {
         // stay same
       },
-      [&](TokenTransferInvoice &tokenTransferInvoice) {
-        const auto state = _state.current();
-        const auto it = state.tokenStates.find(tokenTransferInvoice.token);
-        if (it != state.tokenStates.end()) {
-          tokenTransferInvoice.rootContractAddress = it->first.rootContractAddress();
-          tokenTransferInvoice.walletContractAddress = it->second.walletContractAddress;
-        }
-        tokenTransferInvoice.realAmount = Ton::TokenTransactionToSend::realAmount;
-      },
+      [&](TokenTransferInvoice &tokenTransferInvoice) { PrepareTokenTransfer(tokenTransferInvoice, _state.current()); },
       [&](StakeInvoice &stakeInvoice) {
         stakeInvoice.realAmount = stakeInvoice.stake + Ton::StakeTransactionToSend::depoolFee;
       },
@@ -1274,11 +1664,14 @@ void Window::confirmTransaction(PreparedInvoice invoice, const Fn<void(InvoiceFi
         });
   };
 
+  const auto account = _state.current().account;
+  const auto availableTon = int128(account.fullBalance - account.lockedBalance);
+
   v::match(
       invoice,
       [&](const TonTransferInvoice &tonTransferInvoice) {
-        _wallet->checkSendGrams(getMainPublicKey(), tonTransferInvoice.asTransaction(),
-                                crl::guard(_sendBox.data(), doneUnchanged));
+        _feeEstimator->check(getMainPublicKey(), tonTransferInvoice, availableTon,
+                             crl::guard(_sendBox.data(), doneUnchanged));
       },
       [&](const TokenTransferInvoice &tokenTransferInvoice) {
         auto tokenHandler =
@@ -1310,8 +1703,8 @@ void Window::confirmTransaction(PreparedInvoice invoice, const Fn<void(InvoiceFi
               };
             };
 
-        _wallet->checkSendTokens(getMainPublicKey(), tokenTransferInvoice.asTransaction(),
-                                 crl::guard(_sendBox.data(), std::move(tokenHandler)));
+        _feeEstimator->check(getMainPublicKey(), tokenTransferInvoice, availableTon,
+                             crl::guard(_sendBox.data(), std::move(tokenHandler)));
       },
       [&](const StakeInvoice &stakeInvoice) {
         _wallet->checkSendStake(getMainPublicKey(), stakeInvoice.asTransaction(),
@@ -1348,6 +1741,7 @@ void Window::askSendPassword(const PreparedInvoice &invoice, const Fn<void(Invoi
   const auto mainPublicKey = getMainPublicKey();
   const auto sending = std::make_shared<bool>();
   const auto ready = [=](const QByteArray &passcode, const PreparedInvoice &invoice, Fn<void(QString)> showError) {
+    WALLET_TRACE_SPAN("Window::sendTransaction");
     if (*sending) {
       return;
     }
@@ -1603,6 +1997,7 @@ void Window::showSendConfirmation(const PreparedInvoice &invoice, const Ton::Tra
 
 void Window::showSendingTransaction(const Ton::PendingTransaction &transaction, const PreparedInvoice &invoice,
                                     rpl::producer<> confirmed) {
+  WALLET_TRACE_SPAN("Window::showSendingTransaction");
   if (_sendBox) {
     _sendBox->closeBox();
   }
@@ -1806,13 +2201,22 @@ Fn<void(QImage, QString)> Window::shareCallback(const QString &linkCopied, const
                                                 const QString &qr) {
   return [=](const QImage &image, const QString &text) {
     if (!image.isNull()) {
-      auto mime = std::make_unique<QMimeData>();
-      if (!text.isEmpty()) {
-        mime->setText(text);
-      }
-      mime->setImageData(image);
-      QGuiApplication::clipboard()->setMimeData(mime.release());
-      showToast(qr);
+      // Encode PNG on a worker, so the clipboard doesn't convert a large image on the main thread
+      crl::async([=] {
+        auto png = QByteArray();
+        auto buffer = QBuffer(&png);
+        image.save(&buffer, "PNG");
+        crl::on_main(this, [=] {
+          auto mime = std::make_unique<QMimeData>();
+          if (!text.isEmpty()) {
+            mime->setText(text);
+          }
+          mime->setData("image/png", png);
+          mime->setImageData(image);
+          QGuiApplication::clipboard()->setMimeData(mime.release());
+          showToast(qr);
+        });
+      });
     } else {
       QGuiApplication::clipboard()->setText(text);
       showToast((text.indexOf("://") >= 0) ? linkCopied : textCopied);
@@ -2249,7 +2653,7 @@ void Window::importMultisig(const QString &address) {
     }
   };
 
-  _wallet->requestMultisigInfo(  //
+  _contractDetails->multisigInfo(  //
       address, crl::guard(this, [=](Ton::Result<Ton::MultisigInfo> &&result) {
         if (!result.has_value()) {
           std::cout << result.error().details.toStdString() << std::endl;
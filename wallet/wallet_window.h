@@ -45,12 +45,18 @@ class Info;
 struct StakeInvoice;
 enum class InvoiceField;
 class UpdateInfo;
+class UpdatesDispatcher;
+class BatchTransfer;
+class FeeEstimator;
+class ContractDetails;
 enum class InfoTransition;
 using PreparedInvoiceOrLink = std::variant<PreparedInvoice, QString>;
 
 class Window final : public base::has_weak_ptr {
  public:
-  Window(not_null<Ton::Wallet *> wallet, UpdateInfo *updateInfo = nullptr);
+  // Contract details are kept in the `path` folder, for example the one passed to Ton::Wallet,
+  // and are not saved at all if it is empty.
+  Window(not_null<Ton::Wallet *> wallet, UpdateInfo *updateInfo = nullptr, const QString &path = QString());
   ~Window();
 
   void showAndActivate();
@@ -93,7 +99,11 @@ class Window final : public base::has_weak_ptr {
   void showAccount(const QByteArray &publicKey, bool justCreated = false);
   void setupUpdateWithInfo();
   void setupRefreshEach();
+  void setupAnimationsMode();
   void sendMoney(const PreparedInvoiceOrLink &symbol);
+  void batchTransfer();
+  void confirmMultisigTransactions(const QString &address);
+  void askBatchTransferPassword(not_null<BatchTransfer *> transfer, const QByteArray &publicKey);
   void sendStake(const StakeInvoice &invoice);
   void dePoolWithdraw(const WithdrawalInvoice &invoice);
   void dePoolCancelWithdrawal(const CancelWithdrawalInvoice &invoice);
@@ -161,9 +171,12 @@ class Window final : public base::has_weak_ptr {
   std::unique_ptr<DecryptPasswordState> _decryptPasswordState;
 
   const not_null<Ton::Wallet *> _wallet;
+  const std::unique_ptr<UpdatesDispatcher> _updates;
+  const std::unique_ptr<FeeEstimator> _feeEstimator;
   const std::unique_ptr<Ui::Window> _window;
   const std::unique_ptr<Ui::LayerManager> _layers;
   UpdateInfo *const _updateInfo = nullptr;
+  const QString _path;
 
   std::unique_ptr<Create::Manager> _createManager;
   rpl::event_stream<QString> _createSyncing;
@@ -173,6 +186,7 @@ class Window final : public base::has_weak_ptr {
   QString _packedAddress;
   QString _rawAddress;
   std::unique_ptr<Ton::AccountViewer> _viewer;
+  std::unique_ptr<ContractDetails> _contractDetails;
   rpl::variable<Ton::WalletState> _state;
   rpl::variable<std::optional<SelectedAsset>> _selectedAsset;
   rpl::variable<bool> _syncing;
@@ -188,6 +202,7 @@ class Window final : public base::has_weak_ptr {
 
   QPointer<Ui::GenericBox> _sendBox;
   QPointer<Ui::GenericBox> _sendConfirmBox;
+  QPointer<Ui::GenericBox> _batchTransferBox;
   QPointer<Ui::GenericBox> _simpleErrorBox;
   QPointer<Ui::GenericBox> _settingsBox;
   QPointer<Ui::GenericBox> _saveConfirmBox;
@@ -0,0 +1,195 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#include "wallet/wallet_words.h"
+
+#include "ton/ton_wallet.h"
+
+namespace Wallet {
+namespace {
+
+constexpr auto kLettersCount = 26;
+constexpr auto kMaxNearbyWords = 6;
+constexpr auto kMaxPatternLength = 64;
+
+// Sorted word list with the [begin, end) range of words for each first letter,
+// so a prefix query is one binary search inside a small range plus the result copy.
+struct WordsIndex {
+  std::vector<QString> words;
+  std::array<std::pair<int, int>, kLettersCount> ranges = {};
+};
+
+[[nodiscard]] int LetterIndex(QChar ch) {
+  const auto code = ch.unicode();
+  return (code >= 'a' && code <= 'z') ? int(code - 'a') : -1;
+}
+
+WordsIndex BuildIndex() {
+  const auto valid = Ton::Wallet::GetValidWords();
+
+  auto result = WordsIndex();
+  result.words = std::vector<QString>(valid.begin(), valid.end());
+  for (auto i = 0, count = int(result.words.size()); i != count; ++i) {
+    const auto letter = LetterIndex(result.words[i][0]);
+    if (letter < 0) {
+      continue;
+    }
+    auto &range = result.ranges[letter];
+    if (range.first == range.second) {
+      range = {i, i + 1};
+    } else {
+      range.second = i + 1;
+    }
+  }
+  return result;
+}
+
+const WordsIndex &Index() {
+  static const auto result = BuildIndex();
+  return result;
+}
+
+// Bit-parallel Levenshtein distance (Myers / Hyyro) against a pattern up to 64 letters long.
+class EditDistance final {
+ public:
+  explicit EditDistance(const QString &pattern) : _length(pattern.size()) {
+    Expects(_length > 0 && _length <= kMaxPatternLength);
+
+    for (auto i = 0; i != _length; ++i) {
+      const auto letter = LetterIndex(pattern[i]);
+      if (letter >= 0) {
+        _masks[letter] |= (uint64(1) << i);
+      }
+    }
+  }
+
+  [[nodiscard]] int operator()(const QString &text) const {
+    const auto high = uint64(1) << (_length - 1);
+    auto positive = ~uint64(0);
+    auto negative = uint64(0);
+    auto result = _length;
+    for (const auto ch : text) {
+      const auto letter = LetterIndex(ch);
+      const auto equal = (letter >= 0) ? _masks[letter] : uint64(0);
+      const auto xv = equal | negative;
+      const auto xh = (((equal & positive) + positive) ^ positive) | equal;
+      auto horizontalPositive = negative | ~(xh | positive);
+      auto horizontalNegative = positive & xh;
+      if (horizontalPositive & high) {
+        ++result;
+      } else if (horizontalNegative & high) {
+        --result;
+      }
+      horizontalPositive = (horizontalPositive << 1) | 1;
+      horizontalNegative <<= 1;
+      positive = horizontalNegative | ~(xv | horizontalPositive);
+      negative = horizontalPositive & xv;
+    }
+    return result;
+  }
+
+ private:
+  const int _length = 0;
+  std::array<uint64, kLettersCount> _masks = {};
+};
+
+[[nodiscard]] int CommonPrefixLength(const QString &a, const QString &b) {
+  const auto till = std::min(a.size(), b.size());
+  auto result = 0;
+  while (result != till && a[result] == b[result]) {
+    ++result;
+  }
+  return result;
+}
+
+}  // namespace
+
+const std::vector<QString> &ValidWords() {
+  return Index().words;
+}
+
+bool IsValidWord(const QString &word) {
+  const auto &words = ValidWords();
+  return std::binary_search(words.begin(), words.end(), word);
+}
+
+std::vector<QString> WordsByPrefix(const QString &word) {
+  const auto &index = Index();
+
+  const auto adjusted = word.trimmed().toLower();
+  if (adjusted.isEmpty()) {
+    return {};
+  } else if (index.words.empty()) {
+    return {word};
+  }
+  const auto letter = LetterIndex(adjusted[0]);
+  if (letter < 0) {
+    return {};
+  }
+  const auto [begin, end] = index.ranges[letter];
+  const auto till = index.words.begin() + end;
+  const auto from = std::lower_bound(index.words.begin() + begin, till, adjusted);
+  const auto last = std::partition_point(from, till, [&](const QString &valid) { return valid.startsWith(adjusted); });
+  return std::vector<QString>(from, last);
+}
+
+std::vector<QString> WordsNearby(const QString &word, int maxDistance) {
+  const auto adjusted = word.trimmed().toLower();
+  if (adjusted.isEmpty() || adjusted.size() > kMaxPatternLength) {
+    return {};
+  }
+  const auto distance = EditDistance(adjusted);
+
+  struct Candidate {
+    int distance = 0;
+    int prefix = 0;
+    not_null<const QString *> word;
+  };
+  auto candidates = std::vector<Candidate>();
+  for (const auto &valid : ValidWords()) {
+    if (std::abs(valid.size() - adjusted.size()) > maxDistance) {
+      continue;
+    }
+    if (const auto computed = distance(valid); computed <= maxDistance) {
+      candidates.push_back({computed, CommonPrefixLength(adjusted, valid), &valid});
+    }
+  }
+  // Typed words usually start right, so longer common prefixes go first among equal distances.
+  ranges::sort(candidates, [](const Candidate &a, const Candidate &b) {
+    return std::tie(a.distance, b.prefix, *a.word) < std::tie(b.distance, a.prefix, *b.word);
+  });
+  if (candidates.size() > kMaxNearbyWords) {
+    candidates.erase(candidates.begin() + kMaxNearbyWords, candidates.end());
+  }
+  return candidates | ranges::views::transform([](const Candidate &candidate) { return *candidate.word; }) |
+         ranges::to_vector;
+}
+
+std::vector<QString> WordSuggestions(const QString &word) {
+  auto result = WordsByPrefix(word);
+  if (!result.empty() || word.trimmed().size() < 3) {
+    return result;
+  }
+  return WordsNearby(word);
+}
+
+std::vector<PhraseWord> CheckPhrase(const QString &text) {
+  const auto words = text.simplified().toLower().split(' ', Qt::SkipEmptyParts);
+
+  auto result = std::vector<PhraseWord>();
+  result.reserve(words.size());
+  for (const auto &word : words) {
+    const auto valid = IsValidWord(word);
+    result.push_back({
+        .word = word,
+        .valid = valid,
+        .hints = valid ? std::vector<QString>() : WordsNearby(word),
+    });
+  }
+  return result;
+}
+
+}  // namespace Wallet
@@ -0,0 +1,30 @@
+// This file is part of Desktop App Toolkit,
+// a set of libraries for developing nice desktop applications.
+//
+// For license and copyright information please follow this link:
+// https://github.com/desktop-app/legal/blob/master/LEGAL
+//
+#pragma once
+
+namespace Wallet {
+
+// Valid mnemonic words, sorted, built once and shared by all word inputs.
+[[nodiscard]] const std::vector<QString> &ValidWords();
+[[nodiscard]] bool IsValidWord(const QString &word);
+[[nodiscard]] std::vector<QString> WordsByPrefix(const QString &word);
+
+// Valid words within a small edit distance, closest first.
+[[nodiscard]] std::vector<QString> WordsNearby(const QString &word, int maxDistance = 2);
+
+// Prefix matches, or the nearby words if nothing starts with the typed text.
+[[nodiscard]] std::vector<QString> WordSuggestions(const QString &word);
+
+struct PhraseWord {
+  QString word;
+  bool valid = false;
+  std::vector<QString> hints;
+};
+
+[[nodiscard]] std::vector<PhraseWord> CheckPhrase(const QString &text);
+
+}  // namespace Wallet